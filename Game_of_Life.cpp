@@ -7,8 +7,14 @@
  * @date March, 2020
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
+#include <utility>
 
 // Uses cxxopts from https://github.com/jarro2783/cxxopts under the MIT license
 #include "cxxopts/cxxopts.hxx"
@@ -16,6 +22,11 @@
 #include "grid.h"
 #include "world.h"
 #include "zoo.h"
+#include "census.h"
+#include "engine.h"
+#include "placement.h"
+#include "publisher.h"
+#include "step_server.h"
 
 int main(int argc, char *argv[]) {
 
@@ -29,6 +40,18 @@ int main(int argc, char *argv[]) {
             ("s,steps","The number of steps to simulate the world.", cxxopts::value<int>()->default_value("10"))
             ("e,every","Print world to the console every N steps. 0 disables printing.", cxxopts::value<int>()->default_value("0"))
             ("t,toroidal", "Simulate the Game of Life on a torus.", cxxopts::value<bool>()->default_value("false"))
+            ("trim", "Only print and save the occupied region, the bounds of the alive cells.", cxxopts::value<bool>()->default_value("false"))
+            ("census", "Count the objects in the final state by shape, blocks, blinkers, gliders and so on.", cxxopts::value<bool>()->default_value("false"))
+            ("engine", "The step engine to simulate with, one of auto, packed, reference or temporal.", cxxopts::value<std::string>()->default_value("auto"))
+            ("tune", "Time candidate thread counts and band sizes for up to 50ms before simulating, if the engine supports it.", cxxopts::value<bool>()->default_value("false"))
+            ("profile", "The file tuned settings are cached in between runs.", cxxopts::value<std::string>()->default_value("gol_tuning.txt"))
+            ("pages", "The pages large boards are backed by, one of standard, transparent or explicit.", cxxopts::value<std::string>()->default_value("standard"))
+            ("publish", "Publish generations to the named POSIX shared memory segment for other processes to read.", cxxopts::value<std::string>())
+            ("publish-every", "Publish every N steps when --publish is given.", cxxopts::value<int>()->default_value("1"))
+            ("publish-replace", "Replace a shared memory segment already under the --publish name, such as one left by a crashed run.", cxxopts::value<bool>()->default_value("false"))
+            ("serve", "Run as a step server on the unix domain socket at this path instead of simulating a file.", cxxopts::value<std::string>())
+            ("serve-max-cells", "The most cells a step server client may create a world with.", cxxopts::value<std::int64_t>()->default_value("268435456"))
+            ("c,check", "Cross-check the step engine against the reference engine on the input before simulating.", cxxopts::value<bool>()->default_value("false"))
             ("h,help", "Print usage.");
 
     // Actually parse the command line arguments
@@ -44,6 +67,38 @@ int main(int argc, char *argv[]) {
     const int  steps    = result["steps"].as<int>();
     const int  every    = result["every"].as<int>();
     const bool toroidal = result["toroidal"].as<bool>();
+    const bool check    = result["check"].as<bool>();
+    const bool tune     = result["tune"].as<bool>();
+    const bool trim     = result["trim"].as<bool>();
+    const bool census   = result["census"].as<bool>();
+    const int  publish_every = std::max(1, result["publish-every"].as<int>());
+
+    // Show the whole grid, or only its occupied region when trimming
+    const auto shown = [trim](const Grid &state){
+        return trim ? state.occupied() : GridView(state);
+    };
+
+    // Choose the pages large boards are backed by before any are allocated
+    try {
+        Placement::set_page_mode(Placement::parse_page_mode(result["pages"].as<std::string>()));
+    }
+    catch (const std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        std::exit(-1);
+    }
+
+    // In server mode clients upload their own worlds, run until killed
+    if (result.count("serve")) {
+        try {
+            StepServer server(result["serve"].as<std::string>(), 0, result["serve-max-cells"].as<std::int64_t>());
+            server.run();
+        }
+        catch (const std::exception &ex) {
+            std::cerr << ex.what() << std::endl;
+            std::exit(-1);
+        }
+        return 0;
+    }
 
     // Start with an empty grid
     Grid grid;
@@ -59,34 +114,93 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    // Construct a world from the parsed grid
-    World world(grid);
+    // Pick the step engine, resolving auto from the size of the parsed grid
+    std::string engine_name = result["engine"].as<std::string>();
+    if (engine_name == "auto") {
+        engine_name = Engines::choose(grid);
+    }
+
+    std::unique_ptr<Engine> engine;
+    try {
+        engine = Engines::create(engine_name);
+
+        // Make sure the engine agrees with the reference engine on this input before trusting it
+        if (check && !Engines::cross_check(engine_name, grid, steps, toroidal)) {
+            throw std::runtime_error("Engine " + engine_name + " does not match the reference engine on this input");
+        }
+    }
+    catch (const std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        std::exit(-1);
+    }
 
     // Print the initial state of the grid
     std::cout << "Initial state..." << std::endl
-              << "Alive " << world.get_alive_cells() << " | Dead " << world.get_dead_cells()  << std::endl
-              << world.get_state() << std::endl;
+              << "Alive " << grid.get_alive_cells() << " | Dead " << grid.get_dead_cells()  << std::endl
+              << shown(grid) << std::endl;
 
-    // Perform the requested number of update steps
-    for (int step = 0; step < steps; step++) {
-        world.step(toroidal);
+    // Open the shared memory segment and publish the initial state if asked to
+    std::unique_ptr<Publisher> publisher;
+    if (result.count("publish")) {
+        try {
+            publisher = std::make_unique<Publisher>(result["publish"].as<std::string>(), grid.get_width(), grid.get_height(),
+                                                    3, result["publish-replace"].as<bool>());
+            publisher->publish(grid, 0);
+        }
+        catch (const std::exception &ex) {
+            std::cerr << ex.what() << std::endl;
+            std::exit(-1);
+        }
+    }
+
+    // Hand the parsed grid to the engine rather than copying it
+    engine->load_state(std::move(grid));
+
+    // Let the engine tune itself to this board, reusing any settings cached by an earlier run
+    if (tune && !engine->tune(std::chrono::milliseconds(50), result["profile"].as<std::string>(), toroidal)) {
+        std::cerr << "--tune has no effect on the " << engine_name << " engine, use --engine reference to tune" << std::endl;
+    }
+
+    // Perform the requested number of update steps, running the engine straight through to the next printed
+    // or published step
+    for (int step = 0; step < steps;) {
+        const int next_print = (every > 0) ? ((step + every - 1) / every) * every + 1 : steps;
+        const int next_publish = publisher ? (step / publish_every + 1) * publish_every : steps;
+        const int target = std::min({next_print, next_publish, steps});
+        engine->step(target - step, toroidal);
+        step = target;
+
+        // Publish the state for readers on this host every N steps
+        if (publisher && step % publish_every == 0) {
+            publisher->publish(engine->export_state(), step);
+        }
 
         // Print the state of the grid every N steps
-        if ((every > 0) && (step % every == 0)) {
-            std::cout << "Step " << (step + 1) << " of " << steps << std::endl
-                      << world.get_state() << std::endl;
+        if ((every > 0) && ((step - 1) % every == 0)) {
+            const Grid state = engine->export_state();
+            std::cout << "Step " << step << " of " << steps << std::endl
+                      << shown(state) << std::endl;
         }
     }
 
     // Print the final state of the grid
+    const Grid final_state = engine->export_state();
     std::cout << "Final state..." << std::endl
-              << "Alive " << world.get_alive_cells() << " | Dead " << world.get_dead_cells()  << std::endl
-              << world.get_state() << std::endl;
+              << "Alive " << final_state.get_alive_cells() << " | Dead " << final_state.get_dead_cells()  << std::endl
+              << shown(final_state) << std::endl;
+
+    // Print how many of each object the final state holds if asked to
+    if (census) {
+        std::cout << "Census..." << std::endl;
+        for (const CensusEntry &entry : Census::take(final_state, static_cast<int>(std::thread::hardware_concurrency()))) {
+            std::cout << entry.count << " " << entry.name << std::endl;
+        }
+    }
 
     // Attempt to save to the output directory if a path was given
     if (result.count("output")) {
         try {
-            Zoo::save_ascii(result["output"].as<std::string>(), world.get_state());
+            Zoo::save_ascii(result["output"].as<std::string>(), shown(final_state));
         }
         catch (const std::exception &ex) {
             std::cerr << ex.what() << std::endl;
@@ -0,0 +1,154 @@
+/**
+ * Implements a pool of worker threads that a World keeps between steps to work through its bands of rows.
+ *      - The pool has a fixed number of threads, numbered from 0. The thread calling BandPool::run is thread 0,
+ *        the rest are started when the pool is made and stopped when it is destroyed.
+ *          - A pinned pool starts every thread, thread 0 included, and pins thread n once with
+ *            Placement::pin_to_band(n, threads). The caller only waits, so the same pinned thread always does
+ *            the same band's work, first touching its pages and then stepping it.
+ *      - Every job is run once on every thread, each call is told its thread number and picks its own work.
+ *      - One job runs at a time, BandPool::run returns once every thread has finished it.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+
+#include <stdexcept>
+#include "band_pool.h"
+#include "placement.h"
+
+/**
+ * BandPool::BandPool(threads, pinned = false)
+ *
+ * Start the worker threads, which wait for the first job.
+ *
+ * @example
+ *
+ *      // Keep 8 threads ready for the steps to come
+ *      BandPool pool(8);
+ *
+ *      // Keep 8 threads, each pinned to the CPUs of its own band
+ *      BandPool pinned_pool(8, true);
+ *
+ * @param threads
+ *      The number of threads jobs are split over, counting the thread that calls BandPool::run.
+ *
+ * @param pinned
+ *      Optional parameter. If true then every thread is started and pinned to its band. Defaults to false.
+ *
+ * @throws
+ *      Throws std::runtime_error if there are no threads.
+ */
+BandPool::BandPool(const int threads, const bool pinned) : threads(threads), pinned(pinned){
+    if(threads < 1){
+        throw std::runtime_error("BandPool::BandPool() : Needs at least one thread");
+    }
+    for(int thread = pinned ? 0 : 1; thread < threads; thread++){
+        workers.emplace_back(&BandPool::work, this, thread);
+    }
+}
+
+/**
+ * BandPool::~BandPool()
+ *
+ * Stop and join the worker threads. Must not be called while a job is running.
+ */
+BandPool::~BandPool(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    job_ready.notify_all();
+    for(std::thread &worker : workers){
+        worker.join();
+    }
+}
+
+/**
+ * BandPool::get_threads()
+ *
+ * @return
+ *      The number of threads jobs are split over, counting the thread that calls BandPool::run.
+ */
+int BandPool::get_threads() const{
+    return threads;
+}
+
+/**
+ * BandPool::is_pinned()
+ *
+ * @return
+ *      True if every thread is pinned to the CPUs of its band.
+ */
+bool BandPool::is_pinned() const{
+    return pinned;
+}
+
+/**
+ * BandPool::run(work)
+ *
+ * Run a job on every thread of the pool and wait for all of them to finish it.
+ *
+ * @example
+ *
+ *      // Each thread steps the rows of its own band
+ *      pool.run([&](const int thread){
+ *          const std::pair<int, int> rows = Placement::band_rows(height, thread, pool.get_threads());
+ *          step_rows(rows.first, rows.second);
+ *      });
+ *
+ * @param work
+ *      The job, called with each thread number from 0 to BandPool::get_threads() - 1. It must not throw.
+ */
+void BandPool::run(const std::function<void(int)> &work){
+    if(workers.empty()){
+        work(0);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &work;
+        running = static_cast<int>(workers.size());
+        job_number++;
+    }
+    job_ready.notify_all();
+    if(!pinned){
+        work(0);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    job_done.wait(lock, [this](){ return running == 0; });
+    job = nullptr;
+}
+
+/**
+ * BandPool::work(thread)
+ *
+ * Private helper holding the loop each worker thread runs, taking every job as it comes.
+ *
+ * @param thread
+ *      The worker's thread number.
+ */
+void BandPool::work(const int thread){
+    if(pinned){
+        Placement::pin_to_band(thread, threads);
+    }
+    std::int64_t seen = 0;
+    while(true){
+        const std::function<void(int)> *current;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            job_ready.wait(lock, [this, seen](){ return stopping || job_number != seen; });
+            if(stopping){
+                return;
+            }
+            seen = job_number;
+            current = job;
+        }
+        (*current)(thread);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if(--running == 0){
+            job_done.notify_one();
+        }
+    }
+}
@@ -0,0 +1,46 @@
+/**
+ * Declares a pool of worker threads that a World keeps between steps to work through its bands of rows.
+ * Rich documentation for the api and behaviour the BandPool class can be found in band_pool.cpp.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Declare the structure of the BandPool class, a fixed set of threads that each run their share of a job.
+ *
+ * The threads are started once and then wait between jobs, so a step pays for a wake up rather than for
+ * starting and joining a thread. Pinned pools keep each thread on the CPUs of its band for its whole life.
+ */
+class BandPool {
+private:
+    int threads;
+    bool pinned;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable job_ready;
+    std::condition_variable job_done;
+    const std::function<void(int)> *job = nullptr; // Lives in BandPool::run until every worker is done
+    std::int64_t job_number = 0; // Bumped for every job, workers wait for it to change
+    int running = 0; // Workers still working on the current job
+    bool stopping = false;
+
+    void work(int thread);
+public:
+    explicit BandPool(int threads, bool pinned = false);
+    BandPool(const BandPool &other) = delete;
+    BandPool& operator=(const BandPool &other) = delete;
+    ~BandPool();
+
+    [[nodiscard]] int get_threads() const;
+    [[nodiscard]] bool is_pinned() const;
+    void run(const std::function<void(int)> &work);
+};
@@ -0,0 +1,368 @@
+/**
+ * Implements a Census namespace for labelling the connected objects on a board and counting them by shape.
+ *      - Alive cells touching on a side or a corner belong to the same component, the board edges do not wrap.
+ *
+ *      - Labelling works on runs of alive cells along each row rather than single cells.
+ *          - The rows are split into bands, one per thread. Each thread packs its rows 64 cells to a word and
+ *            pulls the runs out of the words a word at a time.
+ *          - Each thread joins the runs of its band that touch the run above with a union-find. The bands touch
+ *            different runs, so they need no locks. The runs either side of each band edge are joined afterwards.
+ *
+ *      - Each component is canonicalised by trying its eight rotations and reflections, using Grid::rotate and
+ *        Grid::flip, and keeping the smallest. Equal objects in any orientation then have equal canonical shapes.
+ *          - Common still lifes, oscillators and the phases of the glider are named.
+ *          - Oscillators and spaceships change shape between phases, so a phase that is not named, or that falls
+ *            apart into pieces which are not 8-connected, is counted by its shape.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include "census.h"
+
+namespace {
+    struct Run {
+        int y;
+        int x0; // The run spans [x0, x1)
+        int x1;
+    };
+
+    // The first position at or after from whose bit matches want, or width if there is none
+    int next_bit(const std::vector<std::uint64_t> &words, const int from, const bool want, const int width){
+        int index = from / 64;
+        const int words_used = (width + 63) / 64;
+        std::uint64_t word = (want ? words[index] : ~words[index]) & (~std::uint64_t{0} << (from % 64));
+        while(word == 0){
+            if(++index >= words_used){
+                return width;
+            }
+            word = want ? words[index] : ~words[index];
+        }
+        return std::min(width, index * 64 + __builtin_ctzll(word));
+    }
+
+    // Pack a row one cell per bit and append its runs of alive cells
+    void find_runs(const GridView &state, const int y, std::vector<std::uint64_t> &words, std::vector<Run> &runs){
+        const int width = state.get_width();
+        std::fill(words.begin(), words.end(), 0);
+        const Cell *row = &state(0, y);
+        for(int x = 0; x < width; x++){
+            words[x / 64] |= static_cast<std::uint64_t>(row[x] == Cell::ALIVE) << (x % 64);
+        }
+        for(int x = next_bit(words, 0, true, width); x < width; ){
+            const int end = next_bit(words, x, false, width);
+            runs.push_back({y, x, end});
+            x = (end < width) ? next_bit(words, end, true, width) : width;
+        }
+    }
+
+    std::size_t find_root(std::vector<std::size_t> &parent, std::size_t run){
+        while(parent[run] != run){
+            parent[run] = parent[parent[run]];
+            run = parent[run];
+        }
+        return run;
+    }
+
+    void unite(std::vector<std::size_t> &parent, const std::size_t a, const std::size_t b){
+        const std::size_t root_a = find_root(parent, a);
+        const std::size_t root_b = find_root(parent, b);
+        if(root_a != root_b){
+            parent[std::max(root_a, root_b)] = std::min(root_a, root_b);
+        }
+    }
+
+    // Join every run in one row to the runs it touches in the row above, walking both rows left to right
+    void join_rows(const std::vector<Run> &runs, std::vector<std::size_t> &parent,
+                   std::size_t above, const std::size_t above_end, std::size_t below, const std::size_t below_end){
+        while(above < above_end && below < below_end){
+            const Run &a = runs[above];
+            const Run &b = runs[below];
+            if(a.x0 <= b.x1 && b.x0 <= a.x1){
+                unite(parent, above, below);
+            }
+            if(a.x1 < b.x1){
+                above++;
+            } else {
+                below++;
+            }
+        }
+    }
+
+    // The key a shape is compared and looked up by, its size followed by its cells
+    std::string shape_key(const Grid &shape){
+        std::string key = std::to_string(shape.get_width()) + "x" + std::to_string(shape.get_height()) + ":";
+        for(int y = 0; y < shape.get_height(); y++){
+            for(int x = 0; x < shape.get_width(); x++){
+                key += static_cast<char>(shape(x, y));
+            }
+        }
+        return key;
+    }
+
+    Grid draw(const std::vector<std::string> &rows){
+        Grid shape(static_cast<int>(rows[0].size()), static_cast<int>(rows.size()));
+        for(int y = 0; y < shape.get_height(); y++){
+            for(int x = 0; x < shape.get_width(); x++){
+                shape(x, y) = (rows[y][x] == '#') ? Cell::ALIVE : Cell::DEAD;
+            }
+        }
+        return shape;
+    }
+
+    // The names of common objects, keyed by their canonical shapes
+    const std::unordered_map<std::string, std::string> &known_objects(){
+        static const std::unordered_map<std::string, std::string> known = [](){
+            const std::vector<std::pair<std::string, std::vector<std::string>>> drawings = {
+                {"block", {"##", "##"}},
+                {"beehive", {".##.", "#..#", ".##."}},
+                {"loaf", {".##.", "#..#", ".#.#", "..#."}},
+                {"boat", {"##.", "#.#", ".#."}},
+                {"ship", {"##.", "#.#", ".##"}},
+                {"tub", {".#.", "#.#", ".#."}},
+                {"pond", {".##.", "#..#", "#..#", ".##."}},
+                {"barge", {".#..", "#.#.", ".#.#", "..#."}},
+                {"long boat", {".#..", "#.#.", ".#.#", "..##"}},
+                {"blinker", {"###"}},
+                {"toad", {".###", "###."}},
+                {"beacon", {"##..", "##..", "..##", "..##"}},
+                {"glider", {".#.", "..#", "###"}},
+                {"glider", {"#.#", ".##", ".#."}},
+            };
+            std::unordered_map<std::string, std::string> names;
+            for(const auto &drawing : drawings){
+                names.emplace(shape_key(Census::canonical(draw(drawing.second))), drawing.first);
+            }
+            return names;
+        }();
+        return known;
+    }
+}
+
+/**
+ * Census::label(state, threads = 1)
+ *
+ * Find every 8-connected group of alive cells on a board.
+ *
+ * @example
+ *
+ *      // List where the debris of a soup ended up
+ *      for(const Component &component : Census::label(world.get_state(), 8)){
+ *          std::cout << component.x << ", " << component.y << std::endl << component.shape << std::endl;
+ *      }
+ *
+ * @param state
+ *      The board, a grid or a view of part of one.
+ *
+ * @param threads
+ *      Optional parameter. The number of threads to label bands of rows with. Defaults to 1.
+ *
+ * @return
+ *      The components, ordered by the position of their first cell going down the rows.
+ */
+std::vector<Component> Census::label(const GridView &state, const int threads){
+    const int width = state.get_width();
+    const int height = state.get_height();
+    if(width == 0 || height == 0){
+        return {};
+    }
+    const int bands = std::max(1, std::min(threads, height));
+
+    // Each band finds the runs of its own rows, then they are laid end to end
+    std::vector<std::vector<Run>> band_runs(bands);
+    std::vector<std::size_t> row_begin(height + 1);
+    const auto run_bands = [bands](auto work){
+        std::vector<std::thread> workers;
+        for(int band = 1; band < bands; band++){
+            workers.emplace_back(work, band);
+        }
+        work(0);
+        for(std::thread &worker : workers){
+            worker.join();
+        }
+    };
+    run_bands([&](const int band){
+        const std::pair<int, int> rows = Placement::band_rows(height, band, bands);
+        std::vector<std::uint64_t> words((width + 63) / 64);
+        for(int y = rows.first; y < rows.second; y++){
+            row_begin[y] = band_runs[band].size();
+            find_runs(state, y, words, band_runs[band]);
+        }
+    });
+
+    std::vector<std::size_t> band_offset(bands + 1, 0);
+    for(int band = 0; band < bands; band++){
+        band_offset[band + 1] = band_offset[band] + band_runs[band].size();
+    }
+    std::vector<Run> runs(band_offset[bands]);
+    std::vector<std::size_t> parent(runs.size());
+    row_begin[height] = runs.size();
+
+    // Each band joins the runs within it, touching only its own runs
+    run_bands([&](const int band){
+        const std::pair<int, int> rows = Placement::band_rows(height, band, bands);
+        std::copy(band_runs[band].begin(), band_runs[band].end(), runs.begin() + band_offset[band]);
+        for(int y = rows.first; y < rows.second; y++){
+            row_begin[y] += band_offset[band];
+        }
+        for(std::size_t run = band_offset[band]; run < band_offset[band + 1]; run++){
+            parent[run] = run;
+        }
+        for(int y = rows.first + 1; y < rows.second; y++){
+            const std::size_t below_end = (y + 1 < rows.second) ? row_begin[y + 1] : band_offset[band + 1];
+            join_rows(runs, parent, row_begin[y - 1], row_begin[y], row_begin[y], below_end);
+        }
+    });
+
+    // Then the runs either side of each band edge
+    for(int band = 1; band < bands; band++){
+        const int y = Placement::band_rows(height, band, bands).first;
+        join_rows(runs, parent, row_begin[y - 1], row_begin[y], row_begin[y], row_begin[y + 1]);
+    }
+
+    // Number the components in the order their first run turns up, and find their bounds
+    std::vector<std::size_t> component_of(runs.size());
+    std::vector<std::size_t> first_of_root(runs.size(), runs.size());
+    struct Bounds { int x0, y0, x1, y1; };
+    std::vector<Bounds> bounds;
+    for(std::size_t run = 0; run < runs.size(); run++){
+        const std::size_t root = find_root(parent, run);
+        if(first_of_root[root] == runs.size()){
+            first_of_root[root] = bounds.size();
+            bounds.push_back({runs[run].x0, runs[run].y, runs[run].x1, runs[run].y + 1});
+        }
+        const std::size_t component = first_of_root[root];
+        component_of[run] = component;
+        Bounds &box = bounds[component];
+        box.x0 = std::min(box.x0, runs[run].x0);
+        box.x1 = std::max(box.x1, runs[run].x1);
+        box.y1 = runs[run].y + 1;
+    }
+
+    std::vector<Component> components(bounds.size());
+    for(std::size_t component = 0; component < bounds.size(); component++){
+        const Bounds &box = bounds[component];
+        components[component].x = box.x0;
+        components[component].y = box.y0;
+        components[component].shape = Grid(box.x1 - box.x0, box.y1 - box.y0);
+    }
+    for(std::size_t run = 0; run < runs.size(); run++){
+        Component &component = components[component_of[run]];
+        Cell *row = &component.shape(runs[run].x0 - component.x, runs[run].y - component.y);
+        std::fill(row, row + (runs[run].x1 - runs[run].x0), Cell::ALIVE);
+    }
+    return components;
+}
+
+/**
+ * Census::canonical(shape)
+ *
+ * Pick one orientation to stand for a shape in all its rotations and reflections.
+ *
+ * @example
+ *
+ *      // A glider and its mirror image print the same canonical shape
+ *      const Grid glider = Zoo::glider();
+ *      std::cout << Census::canonical(glider) << Census::canonical(glider.flip()) << std::endl;
+ *
+ * @param shape
+ *      The shape, cut to its bounding box.
+ *
+ * @return
+ *      The smallest of the eight rotations and reflections, ordered by size and then by cells.
+ */
+Grid Census::canonical(const Grid &shape){
+    Grid best = shape;
+    std::string best_key = shape_key(shape);
+    const Grid mirrored = shape.flip();
+    Grid candidate;
+    for(const Grid *source : {&shape, &mirrored}){
+        for(int rotation = 0; rotation < 4; rotation++){
+            source->rotate(rotation, candidate);
+            std::string key = shape_key(candidate);
+            if(key < best_key){
+                best_key = std::move(key);
+                best = candidate;
+            }
+        }
+    }
+    return best;
+}
+
+/**
+ * Census::take(state, threads = 1)
+ *
+ * Count the objects on a board by shape, in any rotation or reflection. Best run on a board that has settled,
+ * where every object is a still life, an oscillator or a spaceship on its way out.
+ *
+ * @example
+ *
+ *      // Count what a soup left behind
+ *      World world(soup);
+ *      world.advance(5000);
+ *      for(const CensusEntry &entry : Census::take(world.get_state(), 8)){
+ *          std::cout << entry.count << " " << entry.name << std::endl;
+ *      }
+ *
+ * @param state
+ *      The board, a grid or a view of part of one.
+ *
+ * @param threads
+ *      Optional parameter. The number of threads to label and canonicalise with. Defaults to 1.
+ *
+ * @return
+ *      One entry per distinct object, the most common first and then by name.
+ */
+std::vector<CensusEntry> Census::take(const GridView &state, const int threads){
+    const std::vector<Component> components = label(state, threads);
+
+    // Canonicalise the components in parallel, each thread taking every n-th one
+    const int workers = std::max(1, std::min<int>(threads, static_cast<int>(components.size())));
+    std::vector<Grid> shapes(components.size());
+    std::vector<std::string> keys(components.size());
+    const auto work = [&](const int worker){
+        for(std::size_t i = worker; i < components.size(); i += workers){
+            shapes[i] = canonical(components[i].shape);
+            keys[i] = shape_key(shapes[i]);
+        }
+    };
+    std::vector<std::thread> threads_used;
+    for(int worker = 1; worker < workers; worker++){
+        threads_used.emplace_back(work, worker);
+    }
+    work(0);
+    for(std::thread &thread : threads_used){
+        thread.join();
+    }
+
+    // Tally the shapes, naming the known ones
+    const auto &known = known_objects();
+    std::vector<CensusEntry> entries;
+    std::unordered_map<std::string, std::size_t> entry_of;
+    for(std::size_t i = 0; i < components.size(); i++){
+        const auto found = entry_of.find(keys[i]);
+        if(found != entry_of.end()){
+            entries[found->second].count++;
+            continue;
+        }
+        const auto name = known.find(keys[i]);
+        CensusEntry entry;
+        entry.name = (name != known.end()) ? name->second
+                     : std::to_string(shapes[i].get_width()) + "x" + std::to_string(shapes[i].get_height())
+                       + " with " + std::to_string(shapes[i].get_alive_cells()) + " cells";
+        entry.shape = std::move(shapes[i]);
+        entry.count = 1;
+        entry_of.emplace(keys[i], entries.size());
+        entries.push_back(std::move(entry));
+    }
+
+    std::stable_sort(entries.begin(), entries.end(), [](const CensusEntry &a, const CensusEntry &b){
+        return (a.count != b.count) ? a.count > b.count : a.name < b.name;
+    });
+    return entries;
+}
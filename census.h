@@ -0,0 +1,37 @@
+/**
+ * Declares a Census namespace for labelling the connected objects on a board and counting them by shape.
+ * Rich documentation for the api and behaviour the Census namespace can be found in census.cpp.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "grid.h"
+
+/**
+ * One 8-connected group of alive cells, cut out at its bounding box.
+ */
+struct Component {
+    int x = 0; // The top left corner of the bounding box on the board
+    int y = 0;
+    Grid shape; // The component's cells, other components within the box are left dead
+};
+
+/**
+ * How many times one object turned up in a census.
+ */
+struct CensusEntry {
+    std::string name; // The common name of the object, or its size and population if it has none
+    Grid shape; // The object in its canonical orientation
+    std::int64_t count = 0;
+};
+
+namespace Census {
+    [[nodiscard]] std::vector<Component> label(const GridView &state, int threads = 1);
+    [[nodiscard]] Grid canonical(const Grid &shape);
+    [[nodiscard]] std::vector<CensusEntry> take(const GridView &state, int threads = 1);
+}
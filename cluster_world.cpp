@@ -0,0 +1,468 @@
+/**
+ * Implements a class that splits a world into strips across several local worker processes.
+ *      - The coordinator forks one worker process per strip of rows, split with Placement::band_rows.
+ *          - Each worker copies its strip out of the initial state into its own Grid, with a halo row above and
+ *            below, and steps it in place with a World.
+ *
+ *      - Halo rows are exchanged through a shared memory area mapped before the workers are forked.
+ *          - Every generation each worker writes its top and bottom rows into its slots, then publishes the
+ *            generation number. Its neighbours wait for that number before copying the rows into their halos.
+ *          - The slots alternate between two buffers by generation. A worker cannot write a slot again until both
+ *            neighbours have published the next generation, which they only do after reading it.
+ *          - Strips at the top and bottom of a dead edged board use dead halos, on a torus they wrap round.
+ *
+ *      - The coordinator talks to each worker over a unix socket with small fixed size messages.
+ *          - Stepping replies with the worker's population, so the total is always known after a step.
+ *          - A snapshot streams the worker's rows back, gathered in order into one Grid.
+ *          - The commands and replies are plain byte messages and the halo exchange is confined to the worker
+ *            loop, so either could be carried over a network connection to workers on other nodes.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "cluster_world.h"
+#include "world.h"
+
+namespace {
+    enum Command : std::int32_t {
+        STEP,
+        SNAPSHOT,
+        STOP
+    };
+
+    struct Message {
+        std::int32_t command;
+        std::int32_t steps;
+        std::int32_t toroidal;
+    };
+
+    bool write_all(const int socket, const void *data, std::size_t size){
+        const char *bytes = static_cast<const char *>(data);
+        while(size > 0){
+            const ssize_t written = send(socket, bytes, size, MSG_NOSIGNAL);
+            if(written <= 0){
+                return false;
+            }
+            bytes += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    bool read_all(const int socket, void *data, std::size_t size){
+        char *bytes = static_cast<char *>(data);
+        while(size > 0){
+            const ssize_t got = read(socket, bytes, size);
+            if(got <= 0){
+                return false;
+            }
+            bytes += got;
+            size -= static_cast<std::size_t>(got);
+        }
+        return true;
+    }
+}
+
+/**
+ * ClusterWorld::ClusterWorld(initial_state, processes)
+ *
+ * Split a world into strips of rows and fork a worker process to own each one.
+ *
+ * The workers allocate their strips after they are forked, so a ClusterWorld must be made before the program
+ * starts any other threads. A thread holding the allocator's lock at the fork would leave a worker stuck.
+ *
+ * @example
+ *
+ *      // Run a large board across 8 worker processes
+ *      ClusterWorld world(Zoo::load_binary("path/to/file.bgol"), 8);
+ *      world.advance(1000, true);
+ *      std::cout << world.get_alive_cells() << std::endl;
+ *
+ * @param initial_state
+ *      The state of the world. Each worker copies its own strip, the coordinator does not keep it.
+ *
+ * @param processes
+ *      The number of worker processes. Fewer are used if the board does not have that many rows.
+ *
+ * @throws
+ *      Throws std::runtime_error if there are no processes or the workers cannot be started.
+ */
+ClusterWorld::ClusterWorld(const Grid &initial_state, const int processes)
+    : width(initial_state.get_width()), height(initial_state.get_height()), population(initial_state.get_alive_cells()){
+    if(processes < 1){
+        throw std::runtime_error("ClusterWorld::ClusterWorld() : Needs at least one worker process");
+    }
+    // An empty board has nothing to step, so it gets no workers
+    const int count = (width > 0 && height > 0) ? std::min(processes, height) : 0;
+    if(count == 0){
+        return;
+    }
+
+    // The published generations, then two buffers of a top and a bottom row per worker
+    shared_size = sizeof(Slot) * count + static_cast<std::size_t>(count) * 4 * width;
+    shared = mmap(nullptr, shared_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(shared == MAP_FAILED){
+        shared = nullptr;
+        throw std::runtime_error("ClusterWorld::ClusterWorld() : Could not map the shared halo area");
+    }
+    for(int i = 0; i < count; i++){
+        new (&slots()[i]) Slot{};
+        slots()[i].published.store(-1);
+    }
+
+    workers.resize(count);
+    for(int i = 0; i < count; i++){
+        const std::pair<int, int> rows = Placement::band_rows(height, i, count);
+        workers[i].y_begin = rows.first;
+        workers[i].y_end = rows.second;
+    }
+
+    for(int i = 0; i < count; i++){
+        int ends[2];
+        if(socketpair(AF_UNIX, SOCK_STREAM, 0, ends) != 0){
+            failed = true;
+            shut_down();
+            throw std::runtime_error("ClusterWorld::ClusterWorld() : Could not open a command channel");
+        }
+        const pid_t pid = fork();
+        if(pid == 0){
+            close(ends[0]);
+            // Only this worker's channel is kept, the others belong to the coordinator
+            for(int j = 0; j < i; j++){
+                close(workers[j].socket);
+            }
+            run_worker(i, initial_state, ends[1]);
+        }
+        close(ends[1]);
+        if(pid < 0){
+            close(ends[0]);
+            failed = true;
+            shut_down();
+            throw std::runtime_error("ClusterWorld::ClusterWorld() : Could not start a worker process");
+        }
+        workers[i].pid = pid;
+        workers[i].socket = ends[0];
+    }
+}
+
+/**
+ * ClusterWorld::~ClusterWorld()
+ *
+ * Stop every worker process and release the shared halo area.
+ */
+ClusterWorld::~ClusterWorld(){
+    shut_down();
+}
+
+/**
+ * ClusterWorld::shut_down()
+ *
+ * Private helper that stops every worker process and releases the shared halo area. After a failure the workers
+ * may be stuck waiting on a halo that will never come, so they are killed instead of asked to stop.
+ */
+void ClusterWorld::shut_down(){
+    if(!failed){
+        const Message message{STOP, 0, 0};
+        for(const Worker &worker : workers){
+            write_all(worker.socket, &message, sizeof(message));
+        }
+    }
+    for(Worker &worker : workers){
+        if(worker.pid > 0){
+            if(failed){
+                kill(worker.pid, SIGKILL);
+            }
+            waitpid(worker.pid, nullptr, 0);
+        }
+        if(worker.socket >= 0){
+            close(worker.socket);
+        }
+    }
+    workers.clear();
+    if(shared != nullptr){
+        munmap(shared, shared_size);
+        shared = nullptr;
+    }
+}
+
+/**
+ * ClusterWorld::slots()
+ *
+ * Private helper to find the published generation of each worker in the shared area.
+ *
+ * @return
+ *      The first of the workers' slots.
+ */
+ClusterWorld::Slot *ClusterWorld::slots() const{
+    return static_cast<Slot *>(shared);
+}
+
+/**
+ * ClusterWorld::halo_row(worker, generation, edge)
+ *
+ * Private helper to find where a worker publishes one of its edge rows for a generation.
+ *
+ * @param worker
+ *      The worker that owns the row.
+ *
+ * @param generation
+ *      The generation the row belongs to, which picks one of the two buffers.
+ *
+ * @param edge
+ *      0 for the worker's top row, 1 for its bottom row.
+ *
+ * @return
+ *      The first cell of the row in the shared area.
+ */
+Cell *ClusterWorld::halo_row(const int worker, const std::int64_t generation, const int edge) const{
+    Cell *rows = reinterpret_cast<Cell *>(slots() + workers.size());
+    const std::size_t index = (static_cast<std::size_t>(worker) * 2 + static_cast<std::size_t>(generation % 2)) * 2 + edge;
+    return rows + index * width;
+}
+
+/**
+ * ClusterWorld::run_worker(index, initial_state, socket)
+ *
+ * Private helper holding the loop each worker process runs until it is told to stop.
+ * Never returns, the worker process exits when it is done. If anything throws the worker exits at once with
+ * status 1, the coordinator then finds the channel closed.
+ *
+ * @param index
+ *      The worker's number, which decides its strip of rows.
+ *
+ * @param initial_state
+ *      The whole initial state, shared copy on write with the coordinator, the worker's strip is copied out of it.
+ *
+ * @param socket
+ *      The worker's end of the command channel.
+ */
+void ClusterWorld::run_worker(const int index, const Grid &initial_state, const int socket) const{
+    // Whatever goes wrong, the worker must not unwind into the coordinator's code it was forked from
+    try {
+        const Worker &self = workers[index];
+        const int rows = self.y_end - self.y_begin;
+        const int count = static_cast<int>(workers.size());
+        const int above = (index + count - 1) % count;
+        const int below = (index + 1) % count;
+
+        // The strip with a halo row either side
+        Grid strip(width, rows + 2);
+        strip.merge(initial_state.view(0, self.y_begin, width, self.y_end), 0, 1);
+        World stepper;
+        stepper.set_in_place(true);
+
+        const auto wait_for = [this](const int worker, const std::int64_t generation){
+            while(slots()[worker].published.load(std::memory_order_acquire) < generation){
+                std::this_thread::yield();
+            }
+        };
+
+        std::int64_t generation = 0;
+        Message message{};
+        while(read_all(socket, &message, sizeof(message)) && message.command != STOP){
+            if(message.command == STEP){
+                const bool toroidal = message.toroidal != 0;
+                for(int i = 0; i < message.steps; i++){
+                    // Publish this generation's edge rows
+                    std::memcpy(halo_row(index, generation, 0), &strip(0, 1), width);
+                    std::memcpy(halo_row(index, generation, 1), &strip(0, rows), width);
+                    slots()[index].published.store(generation, std::memory_order_release);
+
+                    // Fill the halos from the neighbours, or with dead rows past a dead edge
+                    Cell *top = &strip(0, 0);
+                    Cell *bottom = &strip(0, rows + 1);
+                    if(index > 0 || toroidal){
+                        wait_for(above, generation);
+                        std::memcpy(top, halo_row(above, generation, 1), width);
+                    } else {
+                        std::fill(top, top + width, Cell::DEAD);
+                    }
+                    if(index < count - 1 || toroidal){
+                        wait_for(below, generation);
+                        std::memcpy(bottom, halo_row(below, generation, 0), width);
+                    } else {
+                        std::fill(bottom, bottom + width, Cell::DEAD);
+                    }
+
+                    // The halos stand in for the top and bottom wrap, so only the sides need to wrap here
+                    stepper.replace_state(std::move(strip));
+                    if(toroidal){
+                        stepper.step<CylinderBoundary>();
+                    } else {
+                        stepper.step<DeadBoundary>();
+                    }
+                    strip = stepper.take_state();
+                    generation++;
+                }
+                const std::int64_t alive = strip.view(0, 1, width, rows + 1).get_alive_cells();
+                if(!write_all(socket, &alive, sizeof(alive))){
+                    break;
+                }
+            } else if(message.command == SNAPSHOT){
+                if(!write_all(socket, &strip(0, 1), static_cast<std::size_t>(rows) * width)){
+                    break;
+                }
+            }
+        }
+    }
+    catch (...) {
+        _exit(1);
+    }
+    _exit(0);
+}
+
+/**
+ * ClusterWorld::send_all(command, steps, toroidal)
+ *
+ * Private helper that sends the same command to every worker.
+ *
+ * @throws
+ *      Throws std::runtime_error if a worker cannot be reached.
+ */
+void ClusterWorld::send_all(const int command, const int steps, const bool toroidal){
+    const Message message{command, steps, toroidal ? 1 : 0};
+    for(const Worker &worker : workers){
+        if(!write_all(worker.socket, &message, sizeof(message))){
+            failed = true;
+            throw std::runtime_error("ClusterWorld::send_all() : Lost contact with a worker process");
+        }
+    }
+}
+
+/**
+ * ClusterWorld::read_reply(worker, data, size)
+ *
+ * Private helper that reads a reply of a known size from a worker.
+ *
+ * @throws
+ *      Throws std::runtime_error if the worker stopped answering.
+ */
+void ClusterWorld::read_reply(const Worker &worker, void *data, const std::size_t size){
+    if(!read_all(worker.socket, data, size)){
+        failed = true;
+        throw std::runtime_error("ClusterWorld::read_reply() : Lost contact with a worker process");
+    }
+}
+
+/**
+ * ClusterWorld::get_width()
+ *
+ * @return
+ *      The width of the world.
+ */
+int ClusterWorld::get_width() const{
+    return width;
+}
+
+/**
+ * ClusterWorld::get_height()
+ *
+ * @return
+ *      The height of the world.
+ */
+int ClusterWorld::get_height() const{
+    return height;
+}
+
+/**
+ * ClusterWorld::get_processes()
+ *
+ * @return
+ *      The number of worker processes, 0 for an empty board.
+ */
+int ClusterWorld::get_processes() const{
+    return static_cast<int>(workers.size());
+}
+
+/**
+ * ClusterWorld::get_alive_cells()
+ *
+ * Gets how many cells in the world are alive, as gathered from the workers after the last step.
+ *
+ * @return
+ *      The number of alive cells.
+ */
+std::int64_t ClusterWorld::get_alive_cells() const{
+    return population;
+}
+
+/**
+ * ClusterWorld::get_state()
+ *
+ * Gather a snapshot of the whole world from the workers.
+ *
+ * @example
+ *
+ *      // Print the world after a few steps
+ *      world.advance(4);
+ *      std::cout << world.get_state() << std::endl;
+ *
+ * @return
+ *      A grid holding the current state of the world.
+ *
+ * @throws
+ *      Throws std::runtime_error if a worker stopped answering.
+ */
+Grid ClusterWorld::get_state(){
+    Grid state(width, height);
+    send_all(SNAPSHOT, 0, false);
+    for(const Worker &worker : workers){
+        read_reply(worker, &state(0, worker.y_begin), static_cast<std::size_t>(worker.y_end - worker.y_begin) * width);
+    }
+    return state;
+}
+
+/**
+ * ClusterWorld::step(toroidal)
+ *
+ * Take one step in Conway's Game of Life across every worker.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom. Defaults to false.
+ */
+void ClusterWorld::step(const bool toroidal){
+    advance(1, toroidal);
+}
+
+/**
+ * ClusterWorld::advance(steps, toroidal)
+ *
+ * Advance multiple steps in the Game of Life. The workers run through all of the steps on their own, only waiting
+ * on their neighbours' halos, and report back their populations at the end.
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom. Defaults to false.
+ *
+ * @throws
+ *      Throws std::runtime_error if a worker stopped answering.
+ */
+void ClusterWorld::advance(const int steps, const bool toroidal){
+    if(steps <= 0 || workers.empty()){
+        return;
+    }
+    send_all(STEP, steps, toroidal);
+    std::int64_t total = 0;
+    for(const Worker &worker : workers){
+        std::int64_t alive = 0;
+        read_reply(worker, &alive, sizeof(alive));
+        total += alive;
+    }
+    population = total;
+}
@@ -0,0 +1,67 @@
+/**
+ * Declares a class that splits a world into strips across several local worker processes.
+ * Rich documentation for the api and behaviour the ClusterWorld class can be found in cluster_world.cpp.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <sys/types.h>
+#include "grid.h"
+
+/**
+ * Declare the structure of the ClusterWorld class, a coordinator for a world split over worker processes.
+ *
+ * Each worker process owns a strip of rows and steps it on its own. Neighbouring strips trade their edge rows
+ * through a shared memory halo area every generation. The coordinator only sends commands and gathers results.
+ */
+class ClusterWorld {
+private:
+    struct alignas(64) Slot {
+        std::atomic<std::int64_t> published; // The last generation whose edge rows this worker has written
+    };
+
+    struct Worker {
+        pid_t pid = -1;
+        int socket = -1; // The coordinator's end of the command channel
+        int y_begin = 0;
+        int y_end = 0;
+    };
+
+    int width = 0;
+    int height = 0;
+    std::int64_t population = 0;
+    std::vector<Worker> workers;
+    void *shared = nullptr; // The published generations followed by the halo rows
+    std::size_t shared_size = 0;
+    bool failed = false;
+
+    [[nodiscard]] Slot *slots() const;
+    [[nodiscard]] Cell *halo_row(int worker, std::int64_t generation, int edge) const;
+    void shut_down();
+    [[noreturn]] void run_worker(int index, const Grid &initial_state, int socket) const;
+    void send_all(int command, int steps, bool toroidal);
+    void read_reply(const Worker &worker, void *data, std::size_t size);
+public:
+    // Constructors & destructors
+    ClusterWorld(const Grid &initial_state, int processes);
+    ClusterWorld(const ClusterWorld &other) = delete;
+    ClusterWorld& operator=(const ClusterWorld &other) = delete;
+    ~ClusterWorld();
+
+    // Getters
+    [[nodiscard]] int get_width() const;
+    [[nodiscard]] int get_height() const;
+    [[nodiscard]] int get_processes() const;
+    [[nodiscard]] std::int64_t get_alive_cells() const;
+    [[nodiscard]] Grid get_state();
+
+    // step functions
+    void step(bool toroidal = false);
+    void advance(int steps, bool toroidal = false);
+};
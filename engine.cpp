@@ -0,0 +1,305 @@
+/**
+ * Implements the shared parts of the step engine interface, the reference engine, and the engine registry.
+ *      - An Engine loads a Grid, steps it forward, and exports it back out as a Grid.
+ *      - The reference engine is World::advance, the behaviour every other engine must match exactly.
+ *      - Engines are registered by name so the command line can pick one without a rebuild.
+ *          - "reference", "packed" and "temporal" are always available.
+ *          - Engines::choose picks a sensible engine for a board, used by the "auto" choice.
+ *          - Engines::cross_check runs an engine against the reference on the same input.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include "engine.h"
+
+/**
+ * Engine::load_state(state)
+ *
+ * Load a copy of a grid, or a view of part of one, into the engine.
+ * Prefer the Grid&& overload when the grid is no longer needed so it can be moved in.
+ *
+ * @example
+ *
+ *      // Load the top left corner of a grid into an engine
+ *      std::unique_ptr<Engine> engine = Engines::create("packed");
+ *      engine->load_state(grid.view(0, 0, 64, 64));
+ *
+ * @param state
+ *      The cells to load.
+ */
+void Engine::load_state(const GridView &state){
+    Grid copy(state.get_width(), state.get_height());
+    copy.merge(state, 0, 0);
+    load_state(std::move(copy));
+}
+
+/**
+ * Engine::tune(budget, profile_path, toroidal)
+ *
+ * Give the engine a chance to tune itself to the loaded board before it is stepped.
+ * Engines with nothing to tune leave this as a no-op and return false.
+ *
+ * @param budget
+ *      Roughly how long the engine may spend tuning.
+ *
+ * @param profile_path
+ *      A file the engine may use to remember tuned settings between runs, or empty for none.
+ *
+ * @param toroidal
+ *      If true then the board will be stepped as a torus.
+ *
+ * @return
+ *      True if the engine tuned itself, false if it has nothing to tune.
+ */
+bool Engine::tune(const std::chrono::milliseconds budget, const std::string &profile_path, const bool toroidal){
+    (void)budget;
+    (void)profile_path;
+    (void)toroidal;
+    return false;
+}
+
+/**
+ * ReferenceEngine::get_name()
+ *
+ * @return
+ *      The registered name of the engine, "reference".
+ */
+std::string ReferenceEngine::get_name() const{
+    return "reference";
+}
+
+/**
+ * ReferenceEngine::load_state(state)
+ *
+ * Move a grid in as the world's current state.
+ *
+ * @param state
+ *      The grid to load, left empty after the move.
+ */
+void ReferenceEngine::load_state(Grid &&state){
+    world.replace_state(std::move(state));
+}
+
+/**
+ * ReferenceEngine::step(steps, toroidal)
+ *
+ * Advance the world using World::advance.
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ *
+ * @param toroidal
+ *      If true then the world is treated as a torus.
+ */
+void ReferenceEngine::step(const int steps, const bool toroidal){
+    world.advance(steps, toroidal);
+}
+
+/**
+ * ReferenceEngine::tune(budget, profile_path, toroidal)
+ *
+ * Pick the thread count and band height for the loaded board using World::calibrate.
+ *
+ * @param budget
+ *      Roughly how long to spend timing candidates.
+ *
+ * @param profile_path
+ *      The file tuned configurations are cached in, or empty for none.
+ *
+ * @param toroidal
+ *      If true then the candidates are timed stepping the board as a torus.
+ *
+ * @return
+ *      True, the world is always tuned.
+ */
+bool ReferenceEngine::tune(const std::chrono::milliseconds budget, const std::string &profile_path, const bool toroidal){
+    world.calibrate(budget, profile_path, toroidal);
+    return true;
+}
+
+/**
+ * ReferenceEngine::export_state()
+ *
+ * @return
+ *      A copy of the world's current state.
+ */
+Grid ReferenceEngine::export_state() const{
+    return world.get_state();
+}
+
+int ReferenceEngine::get_width() const{
+    return world.get_width();
+}
+
+int ReferenceEngine::get_height() const{
+    return world.get_height();
+}
+
+std::int64_t ReferenceEngine::get_alive_cells() const{
+    return world.get_alive_cells();
+}
+
+/**
+ * registry()
+ *
+ * The engine factories by name, with the built in engines registered on first use.
+ *
+ * @return
+ *      A reference to the registry.
+ */
+static std::map<std::string, Engines::Factory>& registry(){
+    static std::map<std::string, Engines::Factory> factories = {
+        {"reference", []{ return std::unique_ptr<Engine>(new ReferenceEngine()); }},
+        {"packed",    []{ return std::unique_ptr<Engine>(new PackedEngine()); }},
+        {"temporal",  []{ return std::unique_ptr<Engine>(new TemporalEngine()); }}
+    };
+    return factories;
+}
+
+/**
+ * Engines::add(name, factory)
+ *
+ * Register an engine so it can be created by name, replacing any engine already using that name.
+ *
+ * @example
+ *
+ *      // Make a new engine available on the command line as --engine mine
+ *      Engines::add("mine", []{ return std::unique_ptr<Engine>(new MyEngine()); });
+ *
+ * @param name
+ *      The name to register the engine under. "auto" is reserved.
+ *
+ * @param factory
+ *      A function returning a new instance of the engine.
+ *
+ * @throws
+ *      std::runtime_error if the name is "auto".
+ */
+void Engines::add(const std::string &name, Factory factory){
+    if(name == "auto"){
+        throw std::runtime_error("Engines::add() : The name auto is reserved");
+    }
+    registry()[name] = std::move(factory);
+}
+
+/**
+ * Engines::get_names()
+ *
+ * @return
+ *      The names of every registered engine in alphabetical order.
+ */
+std::vector<std::string> Engines::get_names(){
+    std::vector<std::string> names;
+    for(const auto &entry : registry()){
+        names.push_back(entry.first);
+    }
+    return names;
+}
+
+/**
+ * Engines::create(name)
+ *
+ * Create a new engine by its registered name.
+ *
+ * @param name
+ *      The name of the engine to create.
+ *
+ * @return
+ *      A new, empty engine.
+ *
+ * @throws
+ *      std::runtime_error if no engine is registered with that name. Resolve "auto" with Engines::choose first.
+ */
+std::unique_ptr<Engine> Engines::create(const std::string &name){
+    const auto entry = registry().find(name);
+    if(entry == registry().end()){
+        std::string known;
+        for(const std::string &registered : get_names()){
+            known += (known.empty() ? "" : ", ") + registered;
+        }
+        throw std::runtime_error("Engines::create() : Unknown engine " + name + ", expected one of: " + known);
+    }
+    return entry->second();
+}
+
+/**
+ * Engines::choose(state)
+ *
+ * Pick an engine for a board, this is what the "auto" engine resolves to.
+ *
+ * Loading into the packed engine and exporting back out costs a pass over the board, which only pays
+ * off once the board is more than a few thousand cells. The packed engine does the same work regardless
+ * of how many cells are alive, so the density does not change the choice between these two.
+ *
+ * @param state
+ *      The board that is about to be simulated.
+ *
+ * @return
+ *      The name of the chosen engine.
+ */
+std::string Engines::choose(const GridView &state){
+    return (state.get_total_cells() < 64 * 64) ? "reference" : "packed";
+}
+
+/**
+ * Engines::cross_check(name, state, steps, toroidal)
+ *
+ * Run an engine and the reference engine side by side on the same input and check that every
+ * generation comes out identical.
+ *
+ * @example
+ *
+ *      // Make sure the packed engine agrees with the reference for 100 steps on a torus
+ *      if(!Engines::cross_check("packed", grid, 100, true)){
+ *          std::cerr << "packed engine disagrees with the reference" << std::endl;
+ *      }
+ *
+ * @param name
+ *      The name of the engine to check.
+ *
+ * @param state
+ *      The initial state given to both engines.
+ *
+ * @param steps
+ *      The number of generations to compare.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then both engines treat the board as a torus. Defaults to false.
+ *
+ * @return
+ *      True if the engines agreed on every generation.
+ */
+bool Engines::cross_check(const std::string &name, const GridView &state, const int steps, const bool toroidal){
+    ReferenceEngine reference;
+    std::unique_ptr<Engine> engine = create(name);
+    reference.load_state(state);
+    engine->load_state(state);
+
+    for(int step = 0; step <= steps; step++){
+        if(step > 0){
+            reference.step(1, toroidal);
+            engine->step(1, toroidal);
+        }
+
+        const Grid expected = reference.export_state();
+        const Grid actual = engine->export_state();
+        if(actual.get_width() != expected.get_width() || actual.get_height() != expected.get_height()){
+            return false;
+        }
+        if(engine->get_alive_cells() != expected.get_alive_cells()){
+            return false;
+        }
+        for(int y = 0; y < expected.get_height(); y++){
+            for(int x = 0; x < expected.get_width(); x++){
+                if(actual.get(x, y) != expected.get(x, y)){
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,118 @@
+/**
+ * Declares an abstract interface for Game of Life step engines, the engines that implement it,
+ * and an Engines namespace holding a registry of them by name.
+ * Rich documentation for the api and behaviour can be found in engine.cpp and the per engine .cpp files.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "grid.h"
+#include "world.h"
+
+/**
+ * Declare the interface every step engine implements.
+ *
+ * An engine owns its own copy of the board in whatever layout suits it. A state is loaded in,
+ * stepped forward any number of generations, and exported back out as a Grid.
+ */
+class Engine {
+public:
+    virtual ~Engine() = default;
+
+    [[nodiscard]] virtual std::string get_name() const = 0;
+    virtual void load_state(Grid &&state) = 0;
+    void load_state(const GridView &state);
+    virtual void step(int steps, bool toroidal = false) = 0;
+    virtual bool tune(std::chrono::milliseconds budget, const std::string &profile_path, bool toroidal);
+    [[nodiscard]] virtual Grid export_state() const = 0;
+    [[nodiscard]] virtual int get_width() const = 0;
+    [[nodiscard]] virtual int get_height() const = 0;
+    [[nodiscard]] virtual std::int64_t get_alive_cells() const = 0;
+};
+
+/**
+ * Declare the reference engine, a thin wrapper around World::advance that every other engine is checked against.
+ */
+class ReferenceEngine : public Engine {
+private:
+    World world;
+public:
+    [[nodiscard]] std::string get_name() const override;
+    void load_state(Grid &&state) override;
+    using Engine::load_state;
+    void step(int steps, bool toroidal) override;
+    bool tune(std::chrono::milliseconds budget, const std::string &profile_path, bool toroidal) override;
+    [[nodiscard]] Grid export_state() const override;
+    [[nodiscard]] int get_width() const override;
+    [[nodiscard]] int get_height() const override;
+    [[nodiscard]] std::int64_t get_alive_cells() const override;
+};
+
+/**
+ * Declare the packed engine, which stores one cell per bit and updates 64 cells at a time with bitwise adders.
+ */
+class PackedEngine : public Engine {
+private:
+    int width = 0;
+    int height = 0;
+    int words_per_row = 0;
+    std::vector<std::uint64_t> cur_words;
+    std::vector<std::uint64_t> next_words;
+    void step_row(int y, bool toroidal);
+public:
+    [[nodiscard]] std::string get_name() const override;
+    void load_state(Grid &&state) override;
+    using Engine::load_state;
+    void step(int steps, bool toroidal) override;
+    [[nodiscard]] Grid export_state() const override;
+    [[nodiscard]] int get_width() const override;
+    [[nodiscard]] int get_height() const override;
+    [[nodiscard]] std::int64_t get_alive_cells() const override;
+};
+
+/**
+ * Declare the temporal engine, which advances square tiles of the board several generations at a time
+ * while they are cached, so each pass over the whole board covers many generations.
+ */
+class TemporalEngine : public Engine {
+private:
+    int width = 0;
+    int height = 0;
+    int tile;
+    int depth;
+    std::vector<std::uint8_t> cur_cells;
+    std::vector<std::uint8_t> next_cells;
+    std::vector<std::uint8_t> tile_cells[2];
+    void advance_tile(int x0, int y0, int generations, bool toroidal);
+public:
+    explicit TemporalEngine(int tile = 128, int depth = 8);
+    [[nodiscard]] std::string get_name() const override;
+    void load_state(Grid &&state) override;
+    using Engine::load_state;
+    void step(int steps, bool toroidal) override;
+    [[nodiscard]] Grid export_state() const override;
+    [[nodiscard]] int get_width() const override;
+    [[nodiscard]] int get_height() const override;
+    [[nodiscard]] std::int64_t get_alive_cells() const override;
+};
+
+/**
+ * Declare the Engines namespace, a registry of engine factories looked up by name.
+ */
+namespace Engines {
+    using Factory = std::function<std::unique_ptr<Engine>()>;
+
+    void add(const std::string &name, Factory factory);
+    [[nodiscard]] std::vector<std::string> get_names();
+    [[nodiscard]] std::unique_ptr<Engine> create(const std::string &name);
+    [[nodiscard]] std::string choose(const GridView &state);
+    [[nodiscard]] bool cross_check(const std::string &name, const GridView &state, int steps, bool toroidal = false);
+}
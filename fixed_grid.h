@@ -0,0 +1,241 @@
+/**
+ * Declares and implements a class template representing a small 2d grid of cells with a size fixed at compile time.
+ *      - Cells live in a std::array inside the object, so a FixedGrid never allocates.
+ *      - Every function is constexpr, so small patterns can be built and simulated entirely at compile time.
+ *      - Stepping applies the rules of Conway's Game of Life, with the same dead or toroidal edges as World.
+ *      - A FixedGrid can be copied out to a Grid to use with the rest of the library.
+ *
+ * The width and height are template arguments so the update loops have constant bounds and can be fully
+ * unrolled by the compiler, which is what makes tiny boards such as a 3x3 glider cheap to simulate.
+ * Being a template the implementation has to live in this header rather than a .cpp file.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+#pragma once
+
+#include <array>
+#include <stdexcept>
+#include "grid.h"
+
+/**
+ * Declare the structure of the FixedGrid class template for representing a W x H grid of cells.
+ *
+ * @tparam W
+ *      The width of the grid.
+ *
+ * @tparam H
+ *      The height of the grid.
+ */
+template <int W, int H>
+class FixedGrid {
+    static_assert(W >= 0 && H >= 0, "FixedGrid : Negative sizes are not valid dimensions");
+private:
+    std::array<Cell, W * H> cells{};
+
+    /**
+     * FixedGrid::alive(x, y, toroidal)
+     *
+     * Private helper returning 1 if the cell is alive, reading out of bounds coordinates as dead
+     * or wrapping them around when toroidal.
+     */
+    [[nodiscard]] constexpr int alive(int x, int y, const bool toroidal) const{
+        if(toroidal){
+            x = (x + W) % W;
+            y = (y + H) % H;
+        } else if(x < 0 || y < 0 || x >= W || y >= H){
+            return 0;
+        }
+        return (cells[y * W + x] == Cell::ALIVE) ? 1 : 0;
+    }
+
+public:
+    /**
+     * FixedGrid::FixedGrid()
+     *
+     * Construct a W x H grid filled with dead cells.
+     *
+     * @example
+     *
+     *      // Make a 5x4 grid at compile time
+     *      constexpr FixedGrid<5, 4> grid;
+     */
+    constexpr FixedGrid(){
+        for(Cell &cell : cells){
+            cell = Cell::DEAD;
+        }
+    }
+
+    /**
+     * FixedGrid::get_width(), get_height(), get_total_cells()
+     *
+     * The dimensions of the grid, known at compile time.
+     */
+    [[nodiscard]] constexpr int get_width() const{ return W; }
+    [[nodiscard]] constexpr int get_height() const{ return H; }
+    [[nodiscard]] constexpr int get_total_cells() const{ return W * H; }
+
+    /**
+     * FixedGrid::get_alive_cells()
+     *
+     * Counts how many cells in the grid are alive.
+     *
+     * @return
+     *      The number of alive cells.
+     */
+    [[nodiscard]] constexpr int get_alive_cells() const{
+        int no_alive = 0;
+        for(const Cell cell : cells){
+            no_alive += (cell == Cell::ALIVE) ? 1 : 0;
+        }
+        return no_alive;
+    }
+
+    /**
+     * FixedGrid::get_dead_cells()
+     *
+     * Counts how many cells in the grid are dead.
+     *
+     * @return
+     *      The number of dead cells.
+     */
+    [[nodiscard]] constexpr int get_dead_cells() const{
+        return get_total_cells() - get_alive_cells();
+    }
+
+    /**
+     * FixedGrid::get(x, y)
+     *
+     * Returns the value of the cell at the desired coordinate.
+     *
+     * @throws
+     *      std::runtime_error if x,y is not a valid coordinate within the grid, which is a compile error
+     *      when evaluated at compile time.
+     */
+    [[nodiscard]] constexpr Cell get(const int x, const int y) const{
+        if(x < 0 || y < 0 || x >= W || y >= H){
+            throw std::runtime_error("FixedGrid::get() : Not a valid grid coordinate");
+        }
+        return (cells[y * W + x] == Cell::ALIVE) ? Cell::ALIVE : Cell::DEAD;
+    }
+
+    /**
+     * FixedGrid::set(x, y, value)
+     *
+     * Overwrites the value at the desired coordinate.
+     *
+     * @throws
+     *      std::runtime_error if x,y is not a valid coordinate within the grid, which is a compile error
+     *      when evaluated at compile time.
+     */
+    constexpr void set(const int x, const int y, const Cell value){
+        if(x < 0 || y < 0 || x >= W || y >= H){
+            throw std::runtime_error("FixedGrid::set() : Not a valid grid coordinate");
+        }
+        cells[y * W + x] = value;
+    }
+
+    /**
+     * FixedGrid::step(toroidal)
+     *
+     * Return the next generation of the grid under the rules of Conway's Game of Life.
+     *
+     * @example
+     *
+     *      // The blinker flips from horizontal to vertical at compile time
+     *      constexpr FixedGrid<3, 3> next = blinker.step();
+     *
+     * @param toroidal
+     *      Optional parameter. If true then the grid is treated as a torus. Defaults to false.
+     *
+     * @return
+     *      A new grid holding the next generation.
+     */
+    [[nodiscard]] constexpr FixedGrid step(const bool toroidal = false) const{
+        FixedGrid next;
+        for(int y = 0; y < H; y++){
+            for(int x = 0; x < W; x++){
+                const int alive_neighbours = alive(x - 1, y - 1, toroidal) + alive(x, y - 1, toroidal) + alive(x + 1, y - 1, toroidal)
+                                           + alive(x - 1, y, toroidal)                                + alive(x + 1, y, toroidal)
+                                           + alive(x - 1, y + 1, toroidal) + alive(x, y + 1, toroidal) + alive(x + 1, y + 1, toroidal);
+                const bool lives = (alive_neighbours == 3) || (alive_neighbours == 2 && cells[y * W + x] == Cell::ALIVE);
+                next.cells[y * W + x] = lives ? Cell::ALIVE : Cell::DEAD;
+            }
+        }
+        return next;
+    }
+
+    /**
+     * FixedGrid::advance(steps, toroidal)
+     *
+     * Return the grid advanced multiple generations.
+     *
+     * @param steps
+     *      The number of steps to advance.
+     *
+     * @param toroidal
+     *      Optional parameter. If true then the grid is treated as a torus. Defaults to false.
+     *
+     * @return
+     *      A new grid holding the advanced generation.
+     */
+    [[nodiscard]] constexpr FixedGrid advance(const int steps, const bool toroidal = false) const{
+        FixedGrid current = *this;
+        for(int i = 0; i < steps; i++){
+            current = current.step(toroidal);
+        }
+        return current;
+    }
+
+    /**
+     * FixedGrid::operator==(other)
+     *
+     * Two grids are equal when every cell matches.
+     */
+    [[nodiscard]] constexpr bool operator==(const FixedGrid &other) const{
+        for(int i = 0; i < W * H; i++){
+            if(cells[i] != other.cells[i]){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    [[nodiscard]] constexpr bool operator!=(const FixedGrid &other) const{
+        return !(*this == other);
+    }
+
+    /**
+     * FixedGrid::to_grid()
+     *
+     * Copy the cells out into a heap allocated Grid of the same size.
+     *
+     * @example
+     *
+     *      // Merge a compile time glider into a world sized grid
+     *      Grid grid(32, 32);
+     *      grid.merge(Zoo::Fixed::glider().to_grid(), 1, 1, true);
+     *
+     * @return
+     *      A Grid holding the same cells.
+     */
+    [[nodiscard]] Grid to_grid() const{
+        Grid grid(W, H);
+        for(int y = 0; y < H; y++){
+            for(int x = 0; x < W; x++){
+                grid.set(x, y, cells[y * W + x]);
+            }
+        }
+        return grid;
+    }
+};
+
+/**
+ * operator<<(output_stream, grid)
+ *
+ * Serializes a fixed size grid to an ascii output stream in the same bordered format as a Grid.
+ */
+template <int W, int H>
+std::ostream& operator<<(std::ostream& output_stream, const FixedGrid<W, H> &grid){
+    return output_stream << grid.to_grid();
+}
@@ -5,6 +5,9 @@
  *      - Grids can be rotated, cropped, and merged together.
  *      - Grids can return counts of the alive and dead cells.
  *      - Grids can be serialized directly to an ascii std::ostream.
+ *      - Grids and views can be narrowed to the occupied region, the bounds of their alive cells.
+ *      - Cells are stored with a PageAllocator, large grids can be backed by huge pages and have each band
+ *        of rows first touched by the worker thread that will step it, see placement.cpp.
  *
  * You are encouraged to use STL container types as an underlying storage mechanism for the grid cells.
  *
@@ -17,8 +20,18 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <thread>
+#include "band_pool.h"
 #include "grid.h"
 
+// Edge length of the square blocks used when transposing, 64x64 cells fit comfortably in L1
+// for both the source and destination so the column-wise side of the copy stays cached.
+constexpr int TRANSPOSE_TILE = 64;
+
 /**
  * Grid::Grid()
  *
@@ -73,12 +86,128 @@ Grid::Grid(const int square_size): Grid(square_size,square_size){} // Call gird
  *
  * @param height
  *      The height of the grid.
+ *
+ * @throws
+ *      Throws std::runtime_error if either size is negative or the grid would be too large to allocate.
  */
 Grid::Grid(const int width, const int height) {
+    const std::size_t size = checked_size(width, height, "Grid::Grid()");
     this->width = width;
     this->height = height;
-    const int size = width*height;
-    this->grid = std::vector<Cell>(size, Cell::DEAD);
+    this->grid.assign(size, Cell::DEAD);
+}
+
+/**
+ * Grid::Grid(width, height, threads)
+ *
+ * Construct a grid with the desired size filled with dead cells, filling the rows in equal bands from
+ * pinned worker threads so each band's pages are placed on the NUMA node of the worker that will step it.
+ * The bands match the ones World::step uses when StepConfig::numa is set with the same number of threads.
+ *
+ * @example
+ *
+ *      // Make a large grid spread over the memory of 8 workers
+ *      Grid grid(65536, 65536, 8);
+ *
+ * @param width
+ *      The width of the grid.
+ *
+ * @param height
+ *      The height of the grid.
+ *
+ * @param threads
+ *      The number of bands, and worker threads, to fill the grid with.
+ *
+ * @throws
+ *      Throws std::runtime_error if either size is negative or the grid would be too large to allocate.
+ */
+Grid::Grid(const int width, const int height, const int threads) {
+    const std::size_t size = checked_size(width, height, "Grid::Grid()");
+    this->width = width;
+    this->height = height;
+    this->grid.resize(size); // Left uninitialised, nothing is placed yet
+    for_each_band(threads, [this](const int y_begin, const int y_end){
+        std::fill(grid.begin() + get_index(0, y_begin), grid.begin() + get_index(0, y_end), Cell::DEAD);
+    });
+}
+
+/**
+ * Grid::Grid(width, height, pool)
+ *
+ * Construct a grid with the desired size filled with dead cells, filling each band of rows from the pool's thread
+ * for that band. With a pinned pool the band's pages are placed on the NUMA node of the thread that will step it.
+ *
+ * @example
+ *
+ *      // Place a grid with the same pinned threads that will go on to step it
+ *      BandPool pool(8, true);
+ *      Grid grid(65536, 65536, pool);
+ *
+ * @param width
+ *      The width of the grid.
+ *
+ * @param height
+ *      The height of the grid.
+ *
+ * @param pool
+ *      The threads to fill the grid with, one band of rows each.
+ *
+ * @throws
+ *      Throws std::runtime_error if either size is negative or the grid would be too large to allocate.
+ */
+Grid::Grid(const int width, const int height, BandPool &pool) {
+    const std::size_t size = checked_size(width, height, "Grid::Grid()");
+    this->width = width;
+    this->height = height;
+    this->grid.resize(size); // Left uninitialised, nothing is placed yet
+    for_each_band(pool, [this](const int y_begin, const int y_end){
+        std::fill(grid.begin() + get_index(0, y_begin), grid.begin() + get_index(0, y_end), Cell::DEAD);
+    });
+}
+
+/**
+ * Grid::Grid(other)
+ *
+ * Move constructor, takes the cells of another grid without copying them. The other grid is left empty, 0x0.
+ *
+ * @example
+ *
+ *      // Hand a large grid on without copying its cells
+ *      Grid grid(65536, 65536);
+ *      Grid taken(std::move(grid)); // grid is now 0x0
+ *
+ * @param other
+ *      The grid to take the cells of.
+ */
+Grid::Grid(Grid &&other) noexcept
+    : width(other.width), height(other.height), grid(std::move(other.grid)){
+    other.width = 0;
+    other.height = 0;
+    other.grid.clear();
+}
+
+/**
+ * Grid::operator=(other)
+ *
+ * Move assignment, takes the cells of another grid without copying them. The other grid is left empty, 0x0.
+ *
+ * @param other
+ *      The grid to take the cells of.
+ *
+ * @return
+ *      A reference to this grid.
+ */
+Grid& Grid::operator=(Grid &&other) noexcept{
+    if(this != &other){
+        width = other.width;
+        height = other.height;
+        grid = std::move(other.grid);
+        other.width = 0;
+        other.height = 0;
+        other.grid.clear();
+        other.grid.shrink_to_fit();
+    }
+    return *this;
 }
 
 /**
@@ -161,9 +290,9 @@ int Grid::get_height() const{
  * @return
  *      The number of total cells.
  */
- int Grid::get_total_cells() const{
+ std::int64_t Grid::get_total_cells() const{
      // The size is how many cells are in the vector.
-     const int size = grid.size(); // Get the size
+     const std::int64_t size = grid.size(); // Get the size
      return size;
  }
 
@@ -191,8 +320,8 @@ int Grid::get_height() const{
  * @return
  *      The number of alive cells.
  */
- int Grid::get_alive_cells() const{
-     const int no_alive = std::count(grid.begin(),grid.end(),Cell::ALIVE);
+ std::int64_t Grid::get_alive_cells() const{
+     const std::int64_t no_alive = std::count(grid.begin(),grid.end(),Cell::ALIVE);
      return no_alive;
  }
 
@@ -221,8 +350,8 @@ int Grid::get_height() const{
  * @return
  *      The number of dead cells.
  */
-int Grid::get_dead_cells() const{
-    const int no_dead = std::count(grid.begin(),grid.end(),Cell::DEAD);
+std::int64_t Grid::get_dead_cells() const{
+    const std::int64_t no_dead = std::count(grid.begin(),grid.end(),Cell::DEAD);
     return no_dead;
 }
 
@@ -267,27 +396,141 @@ void Grid::resize(const int square_size){
  *
  * @param new_height
  *      The new height for the grid.
+ *
+ * @throws
+ *      Throws std::runtime_error if either size is negative or the grid would be too large to allocate.
  */
 void Grid::resize(const int new_width,const int new_height){
     // Dont need to resize if it is the same size
     if(new_width == width && new_height == height){return;}
-    // No negative sizes
-    if(new_width < 0 || new_height < 0){throw std::runtime_error("Grid::resize() : Negative sizes are not valid dimensions");}
-
-    // Create a new grid
-    Grid new_grid(new_width, new_height);
+    // No negative or overflowing sizes
+    const std::size_t new_size = checked_size(new_width, new_height, "Grid::resize()");
 
     // Set the maximum x and y to the smallest of the widths and heights respectively
     const int x_max = (width > new_width) ? new_width : width;
     const int y_max = (height > new_height) ? new_height : height;
 
+    // The rows are shuffled around inside the existing vector so the capacity is reused,
+    // only growing the grid beyond its capacity will allocate.
+    // Row offsets are worked out in std::size_t so boards past 2^31 cells do not overflow
+    const auto old_row = [this](const int y){ return grid.begin() + static_cast<std::ptrdiff_t>(y) * width; };
+    const auto new_row = [this, new_width](const int y){ return grid.begin() + static_cast<std::ptrdiff_t>(y) * new_width; };
+    if(new_width <= width){
+        // Rows only move towards the front so walk forwards
+        for(int y = 0; y < y_max; y++){
+            std::copy_n(old_row(y), x_max, new_row(y));
+        }
+        grid.resize(new_size, Cell::DEAD);
+    } else {
+        // Rows only move towards the back so walk backwards, padding the end of each row
+        grid.resize(new_size, Cell::DEAD);
+        for(int y = y_max - 1; y >= 0; y--){
+            std::copy_backward(old_row(y), old_row(y) + x_max, new_row(y) + x_max);
+            std::fill(new_row(y) + x_max, new_row(y + 1), Cell::DEAD);
+        }
+    }
 
-    new_grid.merge(this->crop(0,0,x_max,y_max),0,0,true);
+    // Anything past the kept rows may hold stale cells from the old layout
+    std::fill(new_row(y_max), grid.end(), Cell::DEAD);
 
-    // Replace the grid, width and heights.
-    grid = new_grid.grid;
-    width = new_grid.width;
-    height = new_grid.height;
+    width = new_width;
+    height = new_height;
+}
+
+
+/**
+ * Grid::first_touch(threads)
+ *
+ * Move the cells into fresh storage, copying the rows in equal bands from pinned worker threads so each band's
+ * pages are placed on the NUMA node of the worker that will step it. Use this on grids that were filled on one
+ * thread, such as a board loaded from file, before stepping them with StepConfig::numa set.
+ *
+ * @example
+ *
+ *      // Spread a loaded board over the memory of 8 workers
+ *      Grid grid = Zoo::load_binary("path/to/file.bgol");
+ *      grid.first_touch(8);
+ *
+ * @param threads
+ *      The number of bands, and worker threads, to copy the grid with.
+ */
+void Grid::first_touch(const int threads){
+    std::vector<Cell, PageAllocator<Cell>> placed;
+    placed.resize(grid.size()); // Left uninitialised, nothing is placed yet
+    for_each_band(threads, [this, &placed](const int y_begin, const int y_end){
+        std::copy(grid.begin() + get_index(0, y_begin), grid.begin() + get_index(0, y_end),
+                  placed.begin() + get_index(0, y_begin));
+    });
+    grid.swap(placed);
+}
+
+/**
+ * Grid::first_touch(pool)
+ *
+ * Move the cells into fresh storage as Grid::first_touch(threads) does, copying each band of rows from the pool's
+ * thread for that band rather than from threads started for the copy.
+ *
+ * @param pool
+ *      The threads to copy the grid with, one band of rows each.
+ */
+void Grid::first_touch(BandPool &pool){
+    std::vector<Cell, PageAllocator<Cell>> placed;
+    placed.resize(grid.size()); // Left uninitialised, nothing is placed yet
+    for_each_band(pool, [this, &placed](const int y_begin, const int y_end){
+        std::copy(grid.begin() + get_index(0, y_begin), grid.begin() + get_index(0, y_end),
+                  placed.begin() + get_index(0, y_begin));
+    });
+    grid.swap(placed);
+}
+
+/**
+ * Grid::for_each_band(threads, work)
+ *
+ * Private helper that splits the rows into Placement::band_rows bands and calls work(y_begin, y_end) for each band
+ * on its own worker thread, from a pinned BandPool made for the call.
+ *
+ * @tparam Work
+ *      A callable taking the first row of a band and one past its last row.
+ *
+ * @param threads
+ *      The number of bands, fewer are used if the grid does not have that many rows.
+ *
+ * @param work
+ *      The work to do on each band.
+ */
+template <typename Work>
+void Grid::for_each_band(const int threads, Work work){
+    const int bands = std::max(1, std::min(threads, height));
+    if(bands == 1){
+        work(0, height);
+        return;
+    }
+    BandPool pool(bands, true);
+    for_each_band(pool, work);
+}
+
+/**
+ * Grid::for_each_band(pool, work)
+ *
+ * Private helper that splits the rows into one Placement::band_rows band for each thread of the pool and calls
+ * work(y_begin, y_end) for each band on its thread. Bands are empty when there are more threads than rows.
+ *
+ * @tparam Work
+ *      A callable taking the first row of a band and one past its last row.
+ *
+ * @param pool
+ *      The threads to work on the bands with.
+ *
+ * @param work
+ *      The work to do on each band.
+ */
+template <typename Work>
+void Grid::for_each_band(BandPool &pool, Work work){
+    const int bands = pool.get_threads();
+    pool.run([&work, bands, this](const int band){
+        const std::pair<int, int> rows = Placement::band_rows(height, band, bands);
+        work(rows.first, rows.second);
+    });
 }
 
 
@@ -307,12 +550,46 @@ void Grid::resize(const int new_width,const int new_height){
  * @return
  *      The 1d offset from the start of the data array where the desired cell is located.
  */
-int Grid::get_index(const int x, const int y) const{
-    const int offset = y * width;
+std::size_t Grid::get_index(const int x, const int y) const{
+    const std::size_t offset = static_cast<std::size_t>(y) * width;
     return offset + x;
 }
 
 
+/**
+ * Grid::checked_size(width, height, caller)
+ *
+ * Private helper function to work out how many cells a grid of the given size holds.
+ * The product is formed in 64 bits and checked against what a std::vector can hold,
+ * so a board too large for the machine is reported instead of silently wrapping around.
+ *
+ * @param width
+ *      The width of the grid.
+ *
+ * @param height
+ *      The height of the grid.
+ *
+ * @param caller
+ *      The name of the calling function, used as the prefix of the error message.
+ *
+ * @return
+ *      The number of cells in a grid of that size.
+ *
+ * @throws
+ *      Throws std::runtime_error if either size is negative or the grid would be too large to allocate.
+ */
+std::size_t Grid::checked_size(const int width, const int height, const char *caller){
+    if(width < 0 || height < 0){
+        throw std::runtime_error(std::string(caller) + " : Negative sizes are not valid dimensions");
+    }
+    const std::size_t max_cells = std::vector<Cell, PageAllocator<Cell>>().max_size();
+    if(height != 0 && static_cast<std::size_t>(width) > max_cells / static_cast<std::size_t>(height)){
+        throw std::runtime_error(std::string(caller) + " : The grid is too large to allocate");
+    }
+    return static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+}
+
+
 /**
  * Grid::get(x, y)
  *
@@ -351,7 +628,7 @@ Cell Grid::get(const int x, const int y) const{
         throw std::runtime_error("Grid::get() : Not a valid grid coordinate");
     }
 
-    const int index = get_index(x, y);
+    const std::size_t index = get_index(x, y);
 
     // If the value is alive return alive otherwise dead.
     return (grid.at(index) == Cell::ALIVE) ? Cell::ALIVE : Cell::DEAD;
@@ -395,7 +672,7 @@ void Grid::set(const int x, const int y, Cell value) {
         throw std::runtime_error("Grid::set() : Not a valid grid coordinate, too low");
     }
     // Check that the values aren't out of bounds
-    const int index = get_index(x, y);
+    const std::size_t index = get_index(x, y);
     grid[index] = value;
 }
 
@@ -446,7 +723,7 @@ Cell& Grid::operator()(const int x, const int y) {
     }
 
     // Get index and return reference
-    const int index = get_index(x, y);
+    const std::size_t index = get_index(x, y);
     Cell & cell = grid.at(index);
     return cell;
 }
@@ -494,12 +771,70 @@ const Cell & Grid::operator()(const int x, const int y) const {
     }
 
     // Get index and return reference
-    const int index = get_index(x, y);
+    const std::size_t index = get_index(x, y);
     const Cell & cell = grid.at(index);
     return cell;
 }
 
 
+/**
+ * Grid::view(x0, y0, x1, y1)
+ *
+ * Get a read-only window onto a rectangle of the grid without copying any cells.
+ * The view spans the range [x0, x1) by [y0, y1) in the original grid, the same as Grid::crop.
+ * The function should be callable from a constant context.
+ *
+ * The view points into this grid's storage, so it must not be used after this grid is
+ * destroyed or resized.
+ *
+ * @example
+ *
+ *      // Make a grid
+ *      Grid grid(4, 4);
+ *
+ *      // Print the centre 2x2 of the grid without making a copy of it
+ *      std::cout << grid.view(1, 1, 3, 3) << std::endl;
+ *
+ * @param x0
+ *      Left coordinate of the window on x-axis.
+ *
+ * @param y0
+ *      Top coordinate of the window on y-axis.
+ *
+ * @param x1
+ *      Right coordinate of the window on x-axis (1 greater than the largest index).
+ *
+ * @param y1
+ *      Bottom coordinate of the window on y-axis (1 greater than the largest index).
+ *
+ * @return
+ *      A view of the window.
+ *
+ * @throws
+ *      std::exception or sub-class if x0,y0 or x1,y1 are not valid coordinates within the grid
+ *      or if the window has a negative size.
+ */
+GridView Grid::view(const int x0, const int y0, const int x1, const int y1) const{
+    return GridView(*this).view(x0, y0, x1, y1);
+}
+
+/**
+ * Grid::occupied()
+ *
+ * Get a view of the smallest rectangle holding every alive cell, see GridView::occupied.
+ *
+ * @example
+ *
+ *      // Save only the part of a large board with anything on it
+ *      Zoo::save_ascii("path/to/file.gol", grid.occupied());
+ *
+ * @return
+ *      A view of the occupied region, 0x0 if there are no alive cells.
+ */
+GridView Grid::occupied() const{
+    return GridView(*this).occupied();
+}
+
 /**
  * Grid::crop(x0, y0, x1, y1)
  *
@@ -535,37 +870,58 @@ const Cell & Grid::operator()(const int x, const int y) const {
  *      or if the crop window has a negative size.
  */
 Grid Grid::crop(const int x0, const int y0, const int x1, const int y1) const{
-    // Handle invalid sizes
-    if ((x0 || x1 )> width || (y0 || y1) > height){
-        throw std::runtime_error("Grid::crop() : Not a valid grid coordinate");
-    }
-    if (x0 < 0 || x1 < 0 || y1 < 0 || y0 < 0){
-        throw std::runtime_error("Grid::crop() : Not a valid grid coordinate");
-    }
+    Grid crop_grid;
+    crop(x0, y0, x1, y1, crop_grid);
+    return crop_grid;
+}
 
-    // Handle reversed inputs
-    if(x1 < x0 || y1 < y0){
-        throw std::runtime_error("Grid::crop() : Invalid x/y bounds");
+/**
+ * Grid::crop(x0, y0, x1, y1, output)
+ *
+ * Extract a sub-grid from a Grid into an existing grid, reusing its storage.
+ * The output grid is resized to the crop window, so keeping one output grid around and cropping
+ * into it repeatedly does not allocate once it has grown large enough.
+ *
+ * @example
+ *
+ *      // Make a grid and a scratch grid to crop into
+ *      Grid y(4, 4), x;
+ *
+ *      // Crop the centre 2x2 in y into x
+ *      y.crop(1, 1, 3, 3, x);
+ *
+ * @param x0
+ *      Left coordinate of the crop window on x-axis.
+ *
+ * @param y0
+ *      Top coordinate of the crop window on y-axis.
+ *
+ * @param x1
+ *      Right coordinate of the crop window on x-axis (1 greater than the largest index).
+ *
+ * @param y1
+ *      Bottom coordinate of the crop window on y-axis (1 greater than the largest index).
+ *
+ * @param output
+ *      The grid to write the cropped cells into. Must not be this grid.
+ *
+ * @throws
+ *      std::exception or sub-class if x0,y0 or x1,y1 are not valid coordinates within the grid
+ *      or if the crop window has a negative size.
+ */
+void Grid::crop(const int x0, const int y0, const int x1, const int y1, Grid &output) const{
+    if(&output == this){
+        throw std::runtime_error("Grid::crop() : Cannot crop a grid into itself");
     }
 
-    // Get the new width and height of the cropped grid
-    const int new_width = x1-x0;
-    const int new_height = y1-y0;
-
-    // Create cropped grid
-    Grid crop_grid(new_width,new_height);
-
-    // Set the alive vars in the cropped grid
-    for(int y = y0; y < y1; y++){
-        for(int x = x0; x < x1; x++){
-            if(get(x,y) == Cell::ALIVE){
-                crop_grid.set(x-x0,y-y0,Cell::ALIVE);
-            }
-        }
-    }
+    // The view checks the window is valid
+    const GridView window = view(x0, y0, x1, y1);
 
-    // Return grid
-    return crop_grid;
+    // Every cell is overwritten so the old contents do not need clearing
+    output.grid.resize(window.get_total_cells());
+    output.width = window.width;
+    output.height = window.height;
+    output.blit(window, 0, 0, 0, window.height, false);
 }
 
 
@@ -579,6 +935,9 @@ Grid Grid::crop(const int x0, const int y0, const int x1, const int y1) const{
  *      - If a cell is originally dead it can be updated to be alive from the merge.
  *      - If a cell is originally alive it cannot be updated to be dead from the merge.
  *
+ * The other grid may be a view of this grid, even one overlapping where it is placed, the result is as if the
+ * view had been copied out first.
+ *
  * @example
  *
  *      // Make two grids
@@ -591,7 +950,7 @@ Grid Grid::crop(const int x0, const int y0, const int x1, const int y1) const{
  *      y.merge(x, 2, 2, true);
  *
  * @param other
- *      The other grid to merge into the current grid.
+ *      The other grid to merge into the current grid, or a view of part of a grid.
  *
  * @param x0
  *      The x coordinate of where to place the top left corner of the other grid.
@@ -606,12 +965,12 @@ Grid Grid::crop(const int x0, const int y0, const int x1, const int y1) const{
  * @throws
  *      std::exception or sub-class if the other grid being placed does not fit within the bounds of the current grid.
  */
-void Grid::merge(const Grid & other, const int x0, const int y0, const bool alive_only){
+void Grid::merge(const GridView & other, const int x0, const int y0, const bool alive_only){
     // kept this-> in to make identifying them easier.
 
     //Get sizes
-    const int other_size = other.get_total_cells();
-    const int this_size = get_total_cells();
+    const std::int64_t other_size = other.get_total_cells();
+    const std::int64_t this_size = get_total_cells();
 
     if(other_size > this_size){
         throw std::runtime_error("Grid::Merge() : The grid is out of bounds");
@@ -625,21 +984,170 @@ void Grid::merge(const Grid & other, const int x0, const int y0, const bool aliv
         throw std::runtime_error("Grid::Merge() : Invalid position");
     }
 
-    for (int y = 0; y < other.get_height(); y++){
-        for (int x = 0; x < other.get_width(); x++){
-            const Cell state = other.get(x,y);
+    // Bounds are checked once above, the rows can be copied over wholesale
+    blit(other, x0, y0, 0, other.get_height(), alive_only);
+}
 
-            if(alive_only){
-                if(state == Cell::ALIVE){ // Check to see if the cell is alive
-                    this->set(x+x0,y+y0,Cell::ALIVE);
-                }
-            } else {
-                // Set the value to match no matter what
-                this->set(x+x0,y+y0,state);
+/**
+ * Grid::blit(other, x0, y0, y_begin, y_end, alive_only)
+ *
+ * Private helper that copies the rows [y_begin, y_end) of other into this grid with its top left corner
+ * at x0, y0. No bounds are checked, callers must have validated the placement.
+ *
+ * Overwriting copies each row in one go, an alive only merge keeps the destination cell wherever the source
+ * is dead which the compiler can turn into a vector blend.
+ *
+ * @param other
+ *      The grid or view to copy rows from.
+ *
+ * @param x0
+ *      The x coordinate of where the top left corner of the other grid is placed.
+ *
+ * @param y0
+ *      The y coordinate of where the top left corner of the other grid is placed.
+ *
+ * @param y_begin
+ *      The first row of the other grid to copy.
+ *
+ * @param y_end
+ *      One past the last row of the other grid to copy.
+ *
+ * @param alive_only
+ *      If true then only alive cells are written.
+ */
+void Grid::blit(const GridView &other, const int x0, const int y0, const int y_begin, const int y_end, const bool alive_only){
+    // A view of this grid can overlap where it is copied to. Both share this grid's row stride, so walking the rows
+    // and cells from the end whenever they move forward reads every cell before it is overwritten, as memmove does
+    const std::less<const Cell *> before;
+    const bool overlaps = !grid.empty() && !before(other.cells, grid.data()) && before(other.cells, grid.data() + grid.size());
+    const bool backwards = overlaps && before(other.cells, grid.data() + get_index(x0, y0));
+
+    for(int step = 0; step < y_end - y_begin; step++){
+        const int y = backwards ? y_end - 1 - step : y_begin + step;
+        const Cell *source = other.row(y);
+        Cell *destination = grid.data() + get_index(x0, y + y0);
+
+        if(alive_only && backwards){
+            for(int x = other.width - 1; x >= 0; x--){
+                destination[x] = (source[x] == Cell::ALIVE) ? Cell::ALIVE : destination[x];
             }
+        } else if(alive_only){
+            std::transform(source, source + other.width, destination, destination,
+                           [](const Cell from, const Cell to){ return (from == Cell::ALIVE) ? Cell::ALIVE : to; });
+        } else if(overlaps){
+            std::memmove(destination, source, static_cast<std::size_t>(other.width) * sizeof(Cell));
+        } else {
+            std::copy(source, source + other.width, destination);
+        }
+    }
+}
+
+/**
+ * Grid::stamp(pattern, positions, rotations = {}, threads = 1)
+ *
+ * Stamp many copies of a pattern into the grid in one go, as if merging each one with alive_only = true.
+ *
+ * Each distinct rotation of the pattern is only built once. Every placement is checked before anything
+ * is written, then the copies are applied in order of their top row so neighbouring stamps hit the same
+ * rows of the grid together. With more than one thread the grid is split into horizontal bands and each
+ * thread applies the parts of every stamp that fall inside its own band, so no two threads write the same row.
+ *
+ * @example
+ *
+ *      // Make a grid
+ *      Grid grid(64, 64);
+ *
+ *      // Place two gliders, the second turned by 90 degrees
+ *      grid.stamp(Zoo::glider(), {{1, 1}, {10, 20}}, {0, 1});
+ *
+ * @param pattern
+ *      The grid to stamp, only its alive cells are written.
+ *
+ * @param positions
+ *      The x, y coordinates of the top left corner of each copy after it has been rotated.
+ *
+ * @param rotations
+ *      Optional parameter. The rotation of each copy in 90 degree intervals, in the same order as positions.
+ *      If empty then no copies are rotated. Defaults to empty.
+ *
+ * @param threads
+ *      Optional parameter. The number of threads to stamp with. Defaults to 1.
+ *
+ * @throws
+ *      std::exception or sub-class if any copy does not fit within the grid, if rotations is not empty and
+ *      not the same size as positions, or if threads is less than 1.
+ */
+void Grid::stamp(const Grid &pattern, const std::vector<std::pair<int, int>> &positions,
+                 const std::vector<int> &rotations, const int threads){
+    if(!rotations.empty() && rotations.size() != positions.size()){
+        throw std::runtime_error("Grid::stamp() : There must be one rotation for each position");
+    }
+    if(threads < 1){
+        throw std::runtime_error("Grid::stamp() : At least one thread is needed");
+    }
 
+    // Build each rotation that is actually used once
+    Grid variants[4];
+    bool built[4] = {false, false, false, false};
+    std::vector<int> variant_of(positions.size(), 0);
+
+    for(std::size_t i = 0; i < positions.size(); i++){
+        const int turn = rotations.empty() ? 0 : ((rotations[i] % 4) + 4) % 4;
+        if(!built[turn]){
+            pattern.rotate(turn, variants[turn]);
+            built[turn] = true;
+        }
+        variant_of[i] = turn;
+
+        // Check every placement up front so a bad one does not leave the grid half stamped
+        const Grid &variant = variants[turn];
+        const int x0 = positions[i].first;
+        const int y0 = positions[i].second;
+        if(x0 < 0 || y0 < 0 || x0 + variant.width > width || y0 + variant.height > height){
+            throw std::runtime_error("Grid::stamp() : The pattern is out of bounds at position " + std::to_string(i));
         }
     }
+
+    // Visit the stamps from top to bottom
+    std::vector<std::size_t> order(positions.size());
+    for(std::size_t i = 0; i < order.size(); i++){
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&positions](const std::size_t a, const std::size_t b){
+        return positions[a].second < positions[b].second;
+    });
+
+    // Apply the part of every stamp that overlaps the rows [band_begin, band_end)
+    auto stamp_band = [&](const int band_begin, const int band_end){
+        for(const std::size_t i : order){
+            const Grid &variant = variants[variant_of[i]];
+            const int x0 = positions[i].first;
+            const int y0 = positions[i].second;
+            if(y0 >= band_end){
+                break;
+            }
+            const int y_begin = std::max(band_begin - y0, 0);
+            const int y_end = std::min(band_end - y0, variant.height);
+            if(y_begin < y_end){
+                blit(variant, x0, y0, y_begin, y_end, true);
+            }
+        }
+    };
+
+    const int bands = std::min(threads, std::max(height, 1));
+    if(bands == 1){
+        stamp_band(0, height);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    for(int band = 0; band < bands; band++){
+        const std::pair<int, int> rows = Placement::band_rows(height, band, bands);
+        workers.emplace_back(stamp_band, rows.first, rows.second);
+    }
+    for(std::thread &worker : workers){
+        worker.join();
+    }
 }
 
 /**
@@ -665,36 +1173,212 @@ void Grid::merge(const Grid & other, const int x0, const int y0, const bool aliv
  *      Returns a copy of the grid that has been rotated.
  */
 Grid Grid::rotate(int rotation)const{
-    int rotations = (rotation%4); // Work out if the grid has been rotated at all
-    Grid rotated(this->get_width(), this->get_height()); // set the grid to the current width and height
-    rotated.grid = this->grid; // make the current and new grids equal
+    Grid rotated;
+    rotate(rotation, rotated);
+    return rotated;
+}
 
-    if (rotations == 0){
-        return rotated; // return the grid
+/**
+ * Grid::rotate(rotation, output)
+ *
+ * Rotate the grid by a multiple of 90 degrees into an existing grid, reusing its storage.
+ * Every multiple of 90 degrees is done in a single pass over the cells, and the output grid is
+ * resized to fit, so rotating into the same scratch grid repeatedly does not allocate.
+ *
+ * @example
+ *
+ *      // Make a 1x3 grid and a scratch grid
+ *      Grid x(1,3), y;
+ *
+ *      // y becomes size 3x1
+ *      x.rotate(1, y);
+ *
+ * @param rotation
+ *      An positive or negative integer to rotate by in 90 intervals.
+ *
+ * @param output
+ *      The grid to write the rotated cells into. Must not be this grid.
+ */
+void Grid::rotate(const int rotation, Grid &output) const{
+    if(&output == this){
+        throw std::runtime_error("Grid::rotate() : Cannot rotate a grid into itself");
     }
 
-    if(rotation < 0){
-        rotations += 4; // Magic maths as %(mod) returns negative numbers and 1 -90 turn == 3 90 turns -1 == 3, -2 == 2 & -3 == 1
+    // Magic maths as %(mod) returns negative numbers and 1 -90 turn == 3 90 turns -1 == 3, -2 == 2 & -3 == 1
+    const int rotations = ((rotation % 4) + 4) % 4;
+
+    // 0 and 180 degrees keep the row order so stream straight through the cells
+    if(rotations == 0){
+        output.width = width;
+        output.height = height;
+        output.grid.assign(grid.begin(), grid.end());
+    } else if(rotations == 2){
+        output.width = width;
+        output.height = height;
+        output.grid.resize(grid.size());
+        std::reverse_copy(grid.begin(), grid.end(), output.grid.begin());
+    } else {
+        // 90 degrees is a transpose with mirrored rows, 270 degrees a transpose with mirrored columns
+        transpose(output, rotations == 1, rotations == 3);
     }
+}
 
-    // Loop through the number of rotations
-    for (int i = 0; i<rotations; i++){
-        Grid temp(rotated.get_height(), rotated.get_width()); // Create temp grid
+/**
+ * Grid::transpose()
+ *
+ * Create a copy of the grid mirrored along its leading diagonal, so cell (x, y) moves to (y, x).
+ * The function should be callable from a constant context.
+ *
+ * @example
+ *
+ *      // Make a 1x3 grid
+ *      Grid x(1,3);
+ *
+ *      // y is size 3x1
+ *      Grid y = x.transpose();
+ *
+ * @return
+ *      Returns a copy of the grid that has been transposed.
+ */
+Grid Grid::transpose() const{
+    Grid transposed;
+    transpose(transposed);
+    return transposed;
+}
 
-        // Loop through this grid (Fancy Transpose and reverse rows)
-        for (int y = 0; y < temp.get_height(); y++){
-            for (int x = 0; x < temp.get_width(); x++){
-                if (rotated.get(y,x) == Cell::ALIVE){ // Check if origin cell is alive
-                    temp.set((temp.get_width()-1)-x,y, Cell::ALIVE); // transpose and reverse.
+/**
+ * Grid::transpose(output)
+ *
+ * Transpose the grid into an existing grid, reusing its storage.
+ *
+ * @example
+ *
+ *      // Make a 1x3 grid and a scratch grid
+ *      Grid x(1,3), y;
+ *
+ *      // y becomes size 3x1
+ *      x.transpose(y);
+ *
+ * @param output
+ *      The grid to write the transposed cells into. Must not be this grid.
+ */
+void Grid::transpose(Grid &output) const{
+    if(&output == this){
+        throw std::runtime_error("Grid::transpose() : Cannot transpose a grid into itself");
+    }
+    transpose(output, false, false);
+}
+
+/**
+ * Grid::transpose(output, mirror_x, mirror_y)
+ *
+ * Private helper that transposes the grid into output and optionally mirrors the result, this is
+ * the shared kernel behind transpose and the 90 and 270 degree rotations.
+ *
+ * A naive transpose reads one side row-wise and the other column-wise, so on large grids nearly every
+ * column-wise access misses the cache. Instead the grid is walked in TRANSPOSE_TILE sized square
+ * blocks, the rows of a block on both sides stay cached while it is copied.
+ *
+ * @param output
+ *      The grid to write to, resized to height x width.
+ *
+ * @param mirror_x
+ *      If true the output columns are reversed, cell (x, y) moves to (height-1-y, x).
+ *
+ * @param mirror_y
+ *      If true the output rows are reversed, cell (x, y) moves to (y, width-1-x).
+ */
+void Grid::transpose(Grid &output, const bool mirror_x, const bool mirror_y) const{
+    // Every cell is overwritten so no clearing is needed
+    output.width = height;
+    output.height = width;
+    output.grid.resize(grid.size());
+
+    for(int by = 0; by < height; by += TRANSPOSE_TILE){
+        const int y_end = std::min(by + TRANSPOSE_TILE, height);
+        for(int bx = 0; bx < width; bx += TRANSPOSE_TILE){
+            const int x_end = std::min(bx + TRANSPOSE_TILE, width);
+
+            for(int x = bx; x < x_end; x++){
+                // Each source column becomes one output row
+                const int out_y = mirror_y ? (width - 1) - x : x;
+                Cell *out_row = output.grid.data() + output.get_index(0, out_y);
+                for(int y = by; y < y_end; y++){
+                    const int out_x = mirror_x ? (height - 1) - y : y;
+                    out_row[out_x] = grid[get_index(x, y)];
                 }
             }
         }
+    }
+}
+
+/**
+ * Grid::flip(vertical)
+ *
+ * Create a mirrored copy of the grid.
+ * The function should be callable from a constant context.
+ *
+ * @example
+ *
+ *      // Make a grid
+ *      Grid x(4, 3);
+ *
+ *      // Mirror it left to right
+ *      Grid y = x.flip();
+ *
+ *      // Mirror it top to bottom
+ *      Grid z = x.flip(true);
+ *
+ * @param vertical
+ *      Optional parameter. If true the rows are mirrored top to bottom, otherwise each row is mirrored
+ *      left to right. Defaults to false.
+ *
+ * @return
+ *      Returns a copy of the grid that has been flipped.
+ */
+Grid Grid::flip(const bool vertical) const{
+    Grid flipped;
+    flip(vertical, flipped);
+    return flipped;
+}
 
-        rotated.resize(temp.get_width(), temp.get_height()); // Resize the rotated array to match the temp
-        rotated = temp; // copy the temp to the rotated
+/**
+ * Grid::flip(vertical, output)
+ *
+ * Mirror the grid into an existing grid, reusing its storage.
+ * Both directions only ever move whole rows or reverse within a row so they stream through memory.
+ *
+ * @example
+ *
+ *      // Make a grid and a scratch grid
+ *      Grid x(4, 3), y;
+ *
+ *      // Mirror x top to bottom into y
+ *      x.flip(true, y);
+ *
+ * @param vertical
+ *      If true the rows are mirrored top to bottom, otherwise each row is mirrored left to right.
+ *
+ * @param output
+ *      The grid to write the flipped cells into. Must not be this grid.
+ */
+void Grid::flip(const bool vertical, Grid &output) const{
+    if(&output == this){
+        throw std::runtime_error("Grid::flip() : Cannot flip a grid into itself");
+    }
+
+    output.width = width;
+    output.height = height;
+    output.grid.resize(grid.size());
+
+    for(int y = 0; y < height; y++){
+        const auto row = grid.begin() + get_index(0, y);
+        if(vertical){
+            std::copy(row, row + width, output.grid.begin() + get_index(0, (height - 1) - y));
+        } else {
+            std::reverse_copy(row, row + width, output.grid.begin() + get_index(0, y));
+        }
     }
-    
-    return rotated;
 }
 
 
@@ -734,25 +1418,53 @@ Grid Grid::rotate(int rotation)const{
  *      Returns a reference to the output stream to enable operator chaining.
  */
 std::ostream& operator<<(std::ostream& output_stream,const Grid &grid){
+    return output_stream << GridView(grid);
+}
+
+/**
+ * operator<<(output_stream, view)
+ *
+ * Serializes a view of a grid to an ascii output stream in the same bordered format as a Grid.
+ * Only the cells inside the view are printed, nothing is copied out of the parent grid.
+ *
+ * @example
+ *
+ *      // Make a 3x3 grid with a single alive cell
+ *      Grid grid(3);
+ *      grid(1, 1) = Cell::ALIVE;
+ *
+ *      // Print the bottom right 2x2 of the grid to the console
+ *      std::cout << grid.view(1, 1, 3, 3) << std::endl;
+ *
+ *      +--+
+ *      |# |
+ *      |  |
+ *      +--+
+ *
+ * @param os
+ *      An ascii mode output stream such as std::cout.
+ *
+ * @param view
+ *      A view of the cells to be printed.
+ *
+ * @return
+ *      Returns a reference to the output stream to enable operator chaining.
+ */
+std::ostream& operator<<(std::ostream& output_stream,const GridView &view){
     // Write row
-    Grid::write_row(output_stream, grid.get_width());
+    Grid::write_row(output_stream, view.get_width());
 
     // Write bulk of grid
-    for (int y = 0; y < grid.get_height(); y++){
+    for (int y = 0; y < view.get_height(); y++){
+        const Cell *row = view.row(y);
         output_stream << '|';
-        for(int x = 0; x < grid.get_width(); x++){
-
-            if (grid.get(x,y) == Cell::ALIVE){
-                output_stream << '#';
-            } else {
-                output_stream << ' ';
-            }
-
+        for(int x = 0; x < view.get_width(); x++){
+            output_stream << ((row[x] == Cell::ALIVE) ? '#' : ' ');
         }
         output_stream << '|'<< std::endl;
     }
 
-    Grid::write_row(output_stream, grid.get_width());
+    Grid::write_row(output_stream, view.get_width());
     return output_stream;
 }
 
@@ -775,3 +1487,266 @@ std::ostream &Grid::write_row(std::ostream &ostream, const int length) {
 
     return ostream;
 }
+
+
+/**
+ * GridView::GridView(grid)
+ *
+ * Construct a view covering the whole of a grid. This is deliberately not explicit so a Grid
+ * can be passed anywhere a GridView is accepted.
+ *
+ * @example
+ *
+ *      // Make a grid
+ *      Grid grid(16, 9);
+ *
+ *      // View all of it
+ *      GridView view = grid;
+ *
+ * @param grid
+ *      The grid to view, it must outlive the view.
+ */
+GridView::GridView(const Grid &grid) : GridView(grid.grid.data(), grid.width, grid.height, grid.width){}
+
+/**
+ * GridView::GridView(cells, width, height, stride)
+ *
+ * Private constructor for a view of width x height cells starting at cells, where each row
+ * starts stride cells after the previous one.
+ *
+ * @param cells
+ *      The top left cell of the view.
+ *
+ * @param width
+ *      The width of the view.
+ *
+ * @param height
+ *      The height of the view.
+ *
+ * @param stride
+ *      The distance between the start of each row, the width of the parent grid.
+ */
+GridView::GridView(const Cell *cells, const int width, const int height, const int stride)
+    : cells(cells), width(width), height(height), stride(stride){}
+
+/**
+ * GridView::get_width()
+ *
+ * Gets the width of the view.
+ *
+ * @return
+ *      The width of the view.
+ */
+int GridView::get_width() const{
+    return width;
+}
+
+/**
+ * GridView::get_height()
+ *
+ * Gets the height of the view.
+ *
+ * @return
+ *      The height of the view.
+ */
+int GridView::get_height() const{
+    return height;
+}
+
+/**
+ * GridView::get_total_cells()
+ *
+ * Gets the total number of cells inside the view.
+ *
+ * @return
+ *      The number of total cells.
+ */
+std::int64_t GridView::get_total_cells() const{
+    return static_cast<std::int64_t>(width) * height;
+}
+
+/**
+ * GridView::get_alive_cells()
+ *
+ * Counts how many cells inside the view are alive.
+ *
+ * @example
+ *
+ *      // Make a grid
+ *      Grid grid(16, 16);
+ *
+ *      // Count the alive cells in the top left quarter
+ *      std::cout << grid.view(0, 0, 8, 8).get_alive_cells() << std::endl;
+ *
+ * @return
+ *      The number of alive cells.
+ */
+std::int64_t GridView::get_alive_cells() const{
+    std::int64_t no_alive = 0;
+    for(int y = 0; y < height; y++){
+        const Cell *cells_row = row(y);
+        no_alive += std::count(cells_row, cells_row + width, Cell::ALIVE);
+    }
+    return no_alive;
+}
+
+/**
+ * GridView::get_dead_cells()
+ *
+ * Counts how many cells inside the view are dead.
+ *
+ * @return
+ *      The number of dead cells.
+ */
+std::int64_t GridView::get_dead_cells() const{
+    return get_total_cells() - get_alive_cells();
+}
+
+/**
+ * GridView::get(x, y)
+ *
+ * Returns the value of the cell at the desired coordinate, relative to the top left of the view.
+ *
+ * @param x
+ *      The x coordinate of the cell within the view.
+ *
+ * @param y
+ *      The y coordinate of the cell within the view.
+ *
+ * @return
+ *      The value of the desired cell. Should only be Grid::ALIVE or Grid::DEAD.
+ *
+ * @throws
+ *      std::exception or sub-class if x,y is not a valid coordinate within the view.
+ */
+Cell GridView::get(const int x, const int y) const{
+    return ((*this)(x, y) == Cell::ALIVE) ? Cell::ALIVE : Cell::DEAD;
+}
+
+/**
+ * GridView::operator()(x, y)
+ *
+ * Gets a read-only reference to the cell at the desired coordinate, relative to the top left of the view.
+ *
+ * @param x
+ *      The x coordinate of the cell within the view.
+ *
+ * @param y
+ *      The y coordinate of the cell within the view.
+ *
+ * @return
+ *      A read-only reference to the desired cell in the parent grid.
+ *
+ * @throws
+ *      std::exception or sub-class if x,y is not a valid coordinate within the view.
+ */
+const Cell& GridView::operator()(const int x, const int y) const{
+    if(x < 0 || y < 0 || x >= width || y >= height){
+        throw std::runtime_error("GridView::operator() : Not a valid view coordinate");
+    }
+    return row(y)[x];
+}
+
+/**
+ * GridView::view(x0, y0, x1, y1)
+ *
+ * Get a narrower view inside this one. The window spans [x0, x1) by [y0, y1) relative to this view.
+ *
+ * @param x0
+ *      Left coordinate of the window on x-axis.
+ *
+ * @param y0
+ *      Top coordinate of the window on y-axis.
+ *
+ * @param x1
+ *      Right coordinate of the window on x-axis (1 greater than the largest index).
+ *
+ * @param y1
+ *      Bottom coordinate of the window on y-axis (1 greater than the largest index).
+ *
+ * @return
+ *      A view of the window over the same parent grid.
+ *
+ * @throws
+ *      std::exception or sub-class if x0,y0 or x1,y1 are not valid coordinates within the view
+ *      or if the window has a negative size.
+ */
+GridView GridView::view(const int x0, const int y0, const int x1, const int y1) const{
+    // Handle invalid sizes
+    if (x0 < 0 || y0 < 0 || x1 > width || y1 > height){
+        throw std::runtime_error("GridView::view() : Not a valid view coordinate");
+    }
+
+    // Handle reversed inputs
+    if(x1 < x0 || y1 < y0){
+        throw std::runtime_error("GridView::view() : Invalid x/y bounds");
+    }
+
+    // An empty window may sit one past the last row so never point past the data
+    const Cell *origin = (x1 == x0 || y1 == y0) ? cells : row(y0) + x0;
+    return GridView(origin, x1 - x0, y1 - y0, stride);
+}
+
+/**
+ * GridView::occupied()
+ *
+ * Get a narrower view of the smallest rectangle holding every alive cell in this one. Printing or saving it
+ * writes only the occupied region, and the position of the region within the grid is not kept.
+ *
+ * @example
+ *
+ *      // Make a 5x5 grid with two alive cells
+ *      Grid grid(5);
+ *      grid(1, 1) = Cell::ALIVE;
+ *      grid(2, 3) = Cell::ALIVE;
+ *
+ *      // Print only the 2x3 rectangle around them
+ *      std::cout << grid.occupied() << std::endl;
+ *
+ *      +--+
+ *      |# |
+ *      |  |
+ *      | #|
+ *      +--+
+ *
+ * @return
+ *      A view of the occupied region over the same parent grid, 0x0 if there are no alive cells.
+ */
+GridView GridView::occupied() const{
+    int x0 = width;
+    int x1 = 0;
+    int y0 = height;
+    int y1 = 0;
+    for(int y = 0; y < height; y++){
+        const Cell *begin = row(y);
+        const Cell *end = begin + width;
+        const Cell *first = std::find(begin, end, Cell::ALIVE);
+        if(first == end){
+            continue;
+        }
+        const Cell *last = std::find(std::make_reverse_iterator(end), std::make_reverse_iterator(first), Cell::ALIVE).base() - 1;
+        x0 = std::min(x0, static_cast<int>(first - begin));
+        x1 = std::max(x1, static_cast<int>(last - begin) + 1);
+        y0 = std::min(y0, y);
+        y1 = y + 1;
+    }
+    if(x0 >= x1){
+        return view(0, 0, 0, 0);
+    }
+    return view(x0, y0, x1, y1);
+}
+
+/**
+ * GridView::row(y)
+ *
+ * Private helper to get a pointer to the first cell of a row in the view, without checking bounds.
+ *
+ * @param y
+ *      The row within the view.
+ *
+ * @return
+ *      A pointer to the leftmost cell of the row.
+ */
+const Cell *GridView::row(const int y) const{
+    return cells + static_cast<std::ptrdiff_t>(y) * stride;
+}
@@ -12,8 +12,12 @@
 
 // Add the minimal number of includes you need in order to declare the class.
 // #include ...
+#include <cstddef>
+#include <cstdint>
 #include <vector>
+#include <utility>
 #include <iostream>
+#include "placement.h"
 
 /**
  * A Cell is a char limited to two named values for Cell::DEAD and Cell::ALIVE.
@@ -23,6 +27,46 @@ enum Cell : char {
     ALIVE = '#'
 };
 
+class BandPool;
+class Grid;
+class Subscriber;
+
+/**
+ * Declare the structure of the GridView class, a read-only window onto the cells of a Grid.
+ *
+ * A view does not own or copy any cells, it points at a rectangle of its parent grid's storage.
+ * The parent grid must outlive the view and must not be resized while the view is in use.
+ */
+class GridView {
+private:
+    const Cell *cells;
+    int width;
+    int height;
+    int stride;
+    GridView(const Cell *cells, int width, int height, int stride);
+    [[nodiscard]] const Cell *row(int y) const;
+    friend class Grid;
+    friend class Subscriber;
+    friend std::ostream& operator<<(std::ostream& output_stream, const GridView& view);
+public:
+    GridView(const Grid &grid);
+
+    // Getters
+    [[nodiscard]] int get_width() const;
+    [[nodiscard]] int get_height() const;
+    [[nodiscard]] std::int64_t get_total_cells() const;
+    [[nodiscard]] std::int64_t get_alive_cells() const;
+    [[nodiscard]] std::int64_t get_dead_cells() const;
+    [[nodiscard]] Cell get(int x, int y) const;
+
+    // Operator overload
+    const Cell& operator()(int x, int y) const;
+
+    // Other Functions
+    [[nodiscard]] GridView view(int x0, int y0, int x1, int y1) const;
+    [[nodiscard]] GridView occupied() const;
+};
+
 /**
  * Declare the structure of the Grid class for representing a 2d grid of cells.
  */
@@ -33,22 +77,37 @@ class Grid {
 private:
     int width;
     int height;
-    std::vector<Cell> grid;
-    [[nodiscard]] int get_index(int x, int y) const;
+    std::vector<Cell, PageAllocator<Cell>> grid;
+    [[nodiscard]] std::size_t get_index(int x, int y) const;
+    static std::size_t checked_size(int width, int height, const char *caller);
+    template <typename Work> void for_each_band(int threads, Work work);
+    template <typename Work> void for_each_band(BandPool &pool, Work work);
+    void transpose(Grid &output, bool mirror_x, bool mirror_y) const;
+    void blit(const GridView &other, int x0, int y0, int y_begin, int y_end, bool alive_only);
     static std::ostream &write_row(std::ostream &ostream, int width);
+    friend class GridView;
     friend std::ostream& operator<<(std::ostream& output_stream, const Grid& grid);
+    friend std::ostream& operator<<(std::ostream& output_stream, const GridView& view);
 public:
     Grid();
     explicit Grid(int square_size);
     Grid(int width, int height);
+    Grid(int width, int height, int threads);
+    Grid(int width, int height, BandPool &pool);
+    Grid(const Grid &other) = default;
+    Grid(Grid &&other) noexcept;
     ~Grid() = default;
 
+    // Assignment
+    Grid& operator=(const Grid &other) = default;
+    Grid& operator=(Grid &&other) noexcept;
+
     // Getters
     [[nodiscard]] int get_width() const;
     [[nodiscard]] int get_height() const;
-    [[nodiscard]] int get_total_cells() const;
-    [[nodiscard]] int get_alive_cells() const;
-    [[nodiscard]] int get_dead_cells() const;
+    [[nodiscard]] std::int64_t get_total_cells() const;
+    [[nodiscard]] std::int64_t get_alive_cells() const;
+    [[nodiscard]] std::int64_t get_dead_cells() const;
     [[nodiscard]] Cell get(int x, int y) const;
 
     // Setters
@@ -61,7 +120,19 @@ public:
     // Other Functions
     void resize(int square_size);
     void resize(int new_width, int new_height);
+    void first_touch(int threads);
+    void first_touch(BandPool &pool);
+    [[nodiscard]] GridView view(int x0, int y0, int x1, int y1) const;
+    [[nodiscard]] GridView occupied() const;
     [[nodiscard]] Grid crop(int x0, int y0, int x1, int y1) const;
-    void merge(const Grid &other, int x0, int y0, bool alive_only = false);
+    void crop(int x0, int y0, int x1, int y1, Grid &output) const;
+    void merge(const GridView &other, int x0, int y0, bool alive_only = false);
+    void stamp(const Grid &pattern, const std::vector<std::pair<int, int>> &positions,
+               const std::vector<int> &rotations = {}, int threads = 1);
     [[nodiscard]] Grid rotate(int rotation) const;
+    void rotate(int rotation, Grid &output) const;
+    [[nodiscard]] Grid transpose() const;
+    void transpose(Grid &output) const;
+    [[nodiscard]] Grid flip(bool vertical = false) const;
+    void flip(bool vertical, Grid &output) const;
 };
\ No newline at end of file
@@ -0,0 +1,300 @@
+/**
+ * Implements a class recording a bounded, seekable history of a world's generations as keyframes and deltas.
+ *      - A keyframe is a Snapshot of a whole generation, taken every keyframe_interval generations.
+ *          - Each keyframe shares the tiles that did not change since the keyframe before, see Snapshot.
+ *
+ *      - Every other generation is a delta from the one before, the row major indices of the cells that flipped.
+ *          - The indices are kept as the gaps between them, each written as a base 128 varint, so a generation
+ *            where a few cells flip costs a few bytes.
+ *
+ *      - Rebuilding a generation writes the nearest keyframe at or before it, then replays the deltas after it.
+ *
+ *      - The memory used by keyframes, deltas and the copy of the newest generation is counted against a budget.
+ *          - Past the budget the oldest keyframe is dropped with the deltas that lead from it, so the history
+ *            always starts at a keyframe. The newest keyframe is never dropped.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "history.h"
+
+namespace {
+    // Approximate the memory held by the tiles of a snapshot that are not shared with another
+    std::size_t tile_bytes(const Snapshot &cells, const std::size_t shared){
+        const std::size_t tiles = cells.get_tile_count();
+        if(tiles == 0){
+            return 0;
+        }
+        const std::size_t total = static_cast<std::size_t>(cells.get_width()) * static_cast<std::size_t>(cells.get_height());
+        return total / tiles * (tiles - shared) + tiles * sizeof(std::shared_ptr<void>);
+    }
+
+    void put_varint(std::vector<std::uint8_t> &output, std::size_t value){
+        while(value >= 0x80){
+            output.push_back(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        output.push_back(static_cast<std::uint8_t>(value));
+    }
+}
+
+/**
+ * History::configure(budget_bytes, interval)
+ *
+ * Set the memory budget and keyframe interval. Anything already recorded is dropped.
+ *
+ * @param budget_bytes
+ *      The memory the history may use, 0 turns recording off.
+ *
+ * @param interval
+ *      The number of generations between keyframes.
+ *
+ * @throws
+ *      Throws std::runtime_error if the interval is less than 1.
+ */
+void History::configure(const std::size_t budget_bytes, const int interval){
+    if(interval < 1){
+        throw std::runtime_error("History::configure() : The keyframe interval must be at least 1");
+    }
+    budget = budget_bytes;
+    keyframe_interval = interval;
+    clear();
+}
+
+/**
+ * History::clear()
+ *
+ * Drop everything recorded, keeping the budget and interval.
+ */
+void History::clear(){
+    keyframes.clear();
+    deltas.clear();
+    latest = Grid();
+    newest = -1;
+    bytes_used = 0;
+}
+
+/**
+ * History::is_enabled()
+ *
+ * @return
+ *      True if the history has a budget to record into.
+ */
+bool History::is_enabled() const{
+    return budget > 0;
+}
+
+/**
+ * History::get_range()
+ *
+ * @return
+ *      The oldest and newest generations that can be rebuilt, both -1 if nothing is recorded.
+ */
+std::pair<std::int64_t, std::int64_t> History::get_range() const{
+    if(keyframes.empty()){
+        return {-1, -1};
+    }
+    return {keyframes.front().generation, newest};
+}
+
+/**
+ * History::get_bytes_used()
+ *
+ * @return
+ *      The memory counted against the budget.
+ */
+std::size_t History::get_bytes_used() const{
+    return bytes_used;
+}
+
+/**
+ * History::start(state, generation)
+ *
+ * Drop everything recorded and start again from a keyframe of the given state.
+ *
+ * @param state
+ *      The state of the generation.
+ *
+ * @param generation
+ *      The generation number of the state.
+ */
+void History::start(const Grid &state, const std::int64_t generation){
+    clear();
+    latest = state;
+    newest = generation;
+    bytes_used = static_cast<std::size_t>(latest.get_total_cells());
+    add_keyframe(generation);
+    trim();
+}
+
+/**
+ * History::truncate(state, generation)
+ *
+ * Drop every generation after the given one, so recording can carry on from it down a new path.
+ *
+ * @param state
+ *      The state of the generation, which must be the one the history rebuilds.
+ *
+ * @param generation
+ *      A generation within History::get_range.
+ */
+void History::truncate(const Grid &state, const std::int64_t generation){
+    while(keyframes.size() > 1 && keyframes.back().generation > generation){
+        bytes_used -= keyframes.back().bytes;
+        keyframes.pop_back();
+    }
+    while(!deltas.empty() && deltas.back().generation > generation){
+        bytes_used -= delta_bytes(deltas.back());
+        deltas.pop_back();
+    }
+    latest = state;
+    newest = generation;
+}
+
+/**
+ * History::record(state, generation)
+ *
+ * Record the generation after the newest one, as a keyframe if the interval is up and as a delta otherwise.
+ * Then drop the oldest keyframes while over budget.
+ *
+ * @param state
+ *      The state of the generation, the same size as the generation before.
+ *
+ * @param generation
+ *      The generation number, one after the newest recorded.
+ */
+void History::record(const Grid &state, const std::int64_t generation){
+    // Find the flipped cells, skipping the rows that did not change
+    Delta delta{generation, {}};
+    const int width = latest.get_width();
+    std::size_t last = 0;
+    for(int y = 0; y < latest.get_height() && width > 0; y++){
+        Cell *old_row = &latest(0, y);
+        const Cell *new_row = &state(0, y);
+        if(std::memcmp(old_row, new_row, width) == 0){
+            continue;
+        }
+        for(int x = 0; x < width; x++){
+            if(old_row[x] != new_row[x]){
+                const std::size_t index = static_cast<std::size_t>(y) * width + x;
+                put_varint(delta.flips, index - last);
+                last = index;
+                old_row[x] = new_row[x];
+            }
+        }
+    }
+    newest = generation;
+
+    if(generation - keyframes.back().generation >= keyframe_interval){
+        add_keyframe(generation);
+    } else {
+        delta.flips.shrink_to_fit();
+        bytes_used += delta_bytes(delta);
+        deltas.push_back(std::move(delta));
+    }
+    trim();
+}
+
+/**
+ * History::rebuild(generation, output)
+ *
+ * Write a recorded generation into a grid, from the nearest keyframe at or before it and the deltas after that.
+ *
+ * @param generation
+ *      The generation to rebuild.
+ *
+ * @param output
+ *      The grid to write, the same size as the recorded generations.
+ *
+ * @throws
+ *      Throws std::runtime_error if the generation is not within History::get_range.
+ */
+void History::rebuild(const std::int64_t generation, Grid &output) const{
+    if(keyframes.empty() || generation < keyframes.front().generation || generation > newest){
+        throw std::runtime_error("History::rebuild() : Generation " + std::to_string(generation) + " is not recorded");
+    }
+
+    const auto keyframe = std::prev(std::upper_bound(keyframes.begin(), keyframes.end(), generation,
+        [](const std::int64_t value, const Keyframe &frame){ return value < frame.generation; }));
+    keyframe->cells.write_to(output);
+
+    const int width = output.get_width();
+    auto delta = std::upper_bound(deltas.begin(), deltas.end(), keyframe->generation,
+        [](const std::int64_t value, const Delta &entry){ return value < entry.generation; });
+    for(; delta != deltas.end() && delta->generation <= generation; ++delta){
+        std::size_t index = 0;
+        std::size_t value = 0;
+        int shift = 0;
+        for(const std::uint8_t byte : delta->flips){
+            value |= static_cast<std::size_t>(byte & 0x7f) << shift;
+            shift += 7;
+            if((byte & 0x80) == 0){
+                index += value;
+                Cell &cell = output(static_cast<int>(index % width), static_cast<int>(index / width));
+                cell = (cell == Cell::ALIVE) ? Cell::DEAD : Cell::ALIVE;
+                value = 0;
+                shift = 0;
+            }
+        }
+    }
+}
+
+/**
+ * History::add_keyframe(generation)
+ *
+ * Private helper that keeps the newest recorded state as a keyframe, sharing tiles with the keyframe before.
+ *
+ * @param generation
+ *      The generation number of the newest recorded state.
+ */
+void History::add_keyframe(const std::int64_t generation){
+    Keyframe keyframe{generation, keyframes.empty() ? Snapshot(latest) : Snapshot(latest, keyframes.back().cells), 0};
+    keyframe.bytes = tile_bytes(keyframe.cells, keyframes.empty() ? 0 : keyframe.cells.count_shared(keyframes.back().cells));
+    bytes_used += keyframe.bytes;
+    keyframes.push_back(std::move(keyframe));
+}
+
+/**
+ * History::trim()
+ *
+ * Private helper that drops the oldest keyframes, and the deltas leading from them, while over budget.
+ */
+void History::trim(){
+    while(bytes_used > budget && keyframes.size() > 1){
+        bytes_used -= keyframes.front().bytes;
+        keyframes.pop_front();
+
+        // The new oldest keyframe is now the only holder of the tiles it shared
+        Keyframe &oldest = keyframes.front();
+        const std::size_t whole = tile_bytes(oldest.cells, 0);
+        bytes_used += whole - oldest.bytes;
+        oldest.bytes = whole;
+
+        while(!deltas.empty() && deltas.front().generation <= oldest.generation){
+            bytes_used -= delta_bytes(deltas.front());
+            deltas.pop_front();
+        }
+    }
+}
+
+/**
+ * History::delta_bytes(delta)
+ *
+ * Private helper for the memory counted for a delta.
+ *
+ * @param delta
+ *      The delta.
+ *
+ * @return
+ *      The size of the delta and its encoded flips.
+ */
+std::size_t History::delta_bytes(const Delta &delta){
+    return sizeof(Delta) + delta.flips.capacity();
+}
@@ -0,0 +1,65 @@
+/**
+ * Declares a class recording a bounded, seekable history of a world's generations as keyframes and deltas.
+ * Rich documentation for the api and behaviour the History class can be found in history.cpp.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+#include "grid.h"
+#include "snapshot.h"
+
+/**
+ * Declare the structure of the History class, the generation history kept by a World.
+ *
+ * Every few generations the whole state is kept as a keyframe Snapshot, and every generation in between is kept
+ * as the list of cells that flipped. The oldest keyframes are dropped to stay within a memory budget.
+ */
+class History {
+private:
+    struct Keyframe {
+        std::int64_t generation;
+        Snapshot cells;
+        std::size_t bytes; // The memory held by tiles not shared with the keyframe before
+    };
+
+    struct Delta {
+        std::int64_t generation; // The generation this delta leads to from the one before
+        std::vector<std::uint8_t> flips; // Gaps between the indices of the flipped cells, as base 128 varints
+    };
+
+    std::size_t budget = 0;
+    int keyframe_interval = 64;
+    std::deque<Keyframe> keyframes;
+    std::deque<Delta> deltas;
+    Grid latest; // The newest recorded generation, to find the next delta against
+    std::int64_t newest = -1;
+    std::size_t bytes_used = 0;
+
+    void add_keyframe(std::int64_t generation);
+    void trim();
+    [[nodiscard]] static std::size_t delta_bytes(const Delta &delta);
+public:
+    // Setup
+    void configure(std::size_t budget_bytes, int interval);
+    void clear();
+    [[nodiscard]] bool is_enabled() const;
+
+    // Getters
+    [[nodiscard]] std::pair<std::int64_t, std::int64_t> get_range() const;
+    [[nodiscard]] std::size_t get_bytes_used() const;
+
+    // Recording
+    void start(const Grid &state, std::int64_t generation);
+    void truncate(const Grid &state, std::int64_t generation);
+    void record(const Grid &state, std::int64_t generation);
+
+    // Seeking
+    void rebuild(std::int64_t generation, Grid &output) const;
+};
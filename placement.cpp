@@ -0,0 +1,267 @@
+/**
+ * Implements the Placement namespace for controlling where the cells of large grids live in memory.
+ *      - Allocations of at least one huge page (2MB) are mapped straight from the kernel, rounded up to
+ *        whole huge pages, and backed by the pages chosen with Placement::set_page_mode.
+ *          - Smaller allocations come from the normal heap, huge pages would only waste memory.
+ *          - How a block is freed depends only on its size, so changing the mode never leaks a block.
+ *      - Freshly mapped pages are not placed on a NUMA node until a thread first writes to them.
+ *        Grid::first_touch and Grid(width, height, threads) write each band of rows from a worker pinned with
+ *        Placement::pin_to_band. A World in numa mode does this with the pinned BandPool threads that go on to
+ *        step the bands, so each band lands on the same node as the thread that steps it.
+ *      - Off Linux every allocation comes from the heap and pinning does nothing.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "placement.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+namespace {
+    constexpr std::size_t HUGE_PAGE_SIZE = std::size_t{2} << 20;
+
+    std::atomic<PageMode> page_mode(PageMode::STANDARD);
+
+    bool is_mapped(const std::size_t bytes){
+#ifdef __linux__
+        return bytes >= HUGE_PAGE_SIZE;
+#else
+        (void) bytes;
+        return false;
+#endif
+    }
+
+    std::size_t mapped_size(const std::size_t bytes){
+        return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+}
+
+/**
+ * Placement::set_page_mode(mode)
+ *
+ * Choose the kind of pages grids allocated from now on are backed by.
+ * Grids that already exist keep the pages they were given.
+ *
+ * @example
+ *
+ *      // Back large boards with transparent huge pages to cut down on TLB misses
+ *      Placement::set_page_mode(PageMode::TRANSPARENT_HUGE);
+ *      Grid grid(16384, 16384);
+ *
+ * @param mode
+ *      The kind of pages to use.
+ */
+void Placement::set_page_mode(const PageMode mode){
+    page_mode.store(mode);
+}
+
+/**
+ * Placement::get_page_mode()
+ *
+ * @return
+ *      The kind of pages new grids are backed by.
+ */
+PageMode Placement::get_page_mode(){
+    return page_mode.load();
+}
+
+/**
+ * Placement::parse_page_mode(name)
+ *
+ * Look up a page mode by the name used on the command line.
+ *
+ * @param name
+ *      One of "standard", "transparent" or "explicit".
+ *
+ * @return
+ *      The named page mode.
+ *
+ * @throws
+ *      Throws std::runtime_error if the name is not a known page mode.
+ */
+PageMode Placement::parse_page_mode(const std::string &name){
+    if(name == "standard"){
+        return PageMode::STANDARD;
+    }
+    if(name == "transparent"){
+        return PageMode::TRANSPARENT_HUGE;
+    }
+    if(name == "explicit"){
+        return PageMode::EXPLICIT_HUGE;
+    }
+    throw std::runtime_error("Placement::parse_page_mode() : Unknown page mode " + name
+                             + ", expected one of standard, transparent or explicit");
+}
+
+/**
+ * Placement::allocate(bytes)
+ *
+ * Allocate uninitialised memory. Blocks of at least one huge page are mapped from the kernel in the current page mode,
+ * so none of their pages are placed until they are first written to.
+ *
+ * @param bytes
+ *      The size of the block.
+ *
+ * @return
+ *      A pointer to the block, which must be freed with Placement::release using the same size.
+ *
+ * @throws
+ *      Throws std::bad_alloc if the memory cannot be found.
+ */
+void *Placement::allocate(const std::size_t bytes){
+    if(!is_mapped(bytes)){
+        return ::operator new(bytes);
+    }
+#ifdef __linux__
+    const std::size_t size = mapped_size(bytes);
+    const PageMode mode = get_page_mode();
+    void *block = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    if(mode == PageMode::EXPLICIT_HUGE){
+        // Reserving up front makes mmap fail, rather than a later page fault, when the pool is too small
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_2MB
+        flags |= MAP_HUGE_2MB;
+#endif
+        block = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    }
+#endif
+
+    // Ordinary pages, also used when the huge page pool has run dry. The kernel's overcommit check still applies,
+    // so a board too large for memory fails here rather than when its pages are first written
+    if(block == MAP_FAILED){
+        block = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(block == MAP_FAILED){
+            throw std::bad_alloc();
+        }
+#ifdef MADV_HUGEPAGE
+        if(mode != PageMode::STANDARD){
+            madvise(block, size, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    return block;
+#else
+    return ::operator new(bytes);
+#endif
+}
+
+/**
+ * Placement::release(pointer, bytes)
+ *
+ * Free a block from Placement::allocate.
+ *
+ * @param pointer
+ *      The block to free, may be nullptr.
+ *
+ * @param bytes
+ *      The size the block was allocated with.
+ */
+void Placement::release(void *pointer, const std::size_t bytes) noexcept{
+    if(pointer == nullptr){
+        return;
+    }
+    if(!is_mapped(bytes)){
+        ::operator delete(pointer);
+        return;
+    }
+#ifdef __linux__
+    munmap(pointer, mapped_size(bytes));
+#endif
+}
+
+/**
+ * Placement::pin_to_band(band, bands)
+ *
+ * Pin the calling thread to its share of the CPUs this process may run on, for band number band of bands.
+ * The CPUs are shared out in order, so neighbouring bands sit on neighbouring CPUs and, on the usual layouts,
+ * the same NUMA node. Any thread pinned for the same band of the same number of bands runs on the same CPUs,
+ * which is what lets the thread that first touched a band's pages and the thread that steps it agree.
+ *
+ * @example
+ *
+ *      // Pin a worker thread for the third of four bands
+ *      Placement::pin_to_band(2, 4);
+ *
+ * @param band
+ *      The band the calling thread works on, from 0 to bands - 1.
+ *
+ * @param bands
+ *      How many bands the work is split into.
+ *
+ * @return
+ *      True if the thread was pinned, false if pinning is not supported here.
+ */
+bool Placement::pin_to_band(const int band, const int bands){
+#ifdef __linux__
+    // Share out the CPUs the thread inherited, band workers are started fresh from an unpinned thread
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if(sched_getaffinity(0, sizeof(allowed), &allowed) != 0){
+        return false;
+    }
+    std::vector<int> cpus;
+    for(int cpu = 0; cpu < CPU_SETSIZE; cpu++){
+        if(CPU_ISSET(cpu, &allowed)){
+            cpus.push_back(cpu);
+        }
+    }
+    if(cpus.empty() || bands < 1){
+        return false;
+    }
+
+    const int count = static_cast<int>(cpus.size());
+    int first = static_cast<int>((static_cast<std::int64_t>(count) * band) / bands);
+    int last = static_cast<int>((static_cast<std::int64_t>(count) * (band + 1)) / bands);
+    if(first == last){
+        // More bands than CPUs, several bands share one
+        last = first + 1;
+    }
+
+    cpu_set_t chosen;
+    CPU_ZERO(&chosen);
+    for(int i = first; i < last; i++){
+        CPU_SET(cpus[i], &chosen);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(chosen), &chosen) == 0;
+#else
+    (void) band;
+    (void) bands;
+    return false;
+#endif
+}
+
+/**
+ * Placement::band_rows(height, band, bands)
+ *
+ * Split the rows of a grid into equal bands. Everything that places or steps rows band by band uses this split,
+ * so a band is always the same rows wherever it is worked on.
+ *
+ * @param height
+ *      The number of rows to split.
+ *
+ * @param band
+ *      The band to find, from 0 to bands - 1.
+ *
+ * @param bands
+ *      How many bands the rows are split into.
+ *
+ * @return
+ *      The first row of the band and one past its last row.
+ */
+std::pair<int, int> Placement::band_rows(const int height, const int band, const int bands){
+    const auto edge = [height, bands](const int b){
+        return static_cast<int>((static_cast<std::int64_t>(height) * b) / bands);
+    };
+    return {edge(band), edge(band + 1)};
+}
@@ -0,0 +1,83 @@
+/**
+ * Declares a Placement namespace for controlling where the cells of large grids live in memory,
+ * and the PageAllocator that Grid uses to get its storage from it.
+ * Rich documentation for the api and behaviour can be found in placement.cpp.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <utility>
+
+/**
+ * The kind of pages large grids are backed by.
+ *      - STANDARD uses ordinary pages.
+ *      - TRANSPARENT_HUGE asks the kernel to back the grid with transparent huge pages where it can.
+ *      - EXPLICIT_HUGE maps pages from the reserved huge page pool, falling back to TRANSPARENT_HUGE when
+ *        the pool is empty.
+ */
+enum class PageMode {
+    STANDARD,
+    TRANSPARENT_HUGE,
+    EXPLICIT_HUGE
+};
+
+/**
+ * Declare the interface of the Placement namespace for allocating page backed storage and pinning band workers.
+ */
+namespace Placement {
+    void set_page_mode(PageMode mode);
+    [[nodiscard]] PageMode get_page_mode();
+    [[nodiscard]] PageMode parse_page_mode(const std::string &name);
+    [[nodiscard]] void *allocate(std::size_t bytes);
+    void release(void *pointer, std::size_t bytes) noexcept;
+    bool pin_to_band(int band, int bands);
+    [[nodiscard]] std::pair<int, int> band_rows(int height, int band, int bands);
+}
+
+/**
+ * Declare an allocator that takes its memory from Placement::allocate and leaves new elements uninitialised.
+ *
+ * Leaving elements uninitialised means growing a vector does not write to, and so does not place, any pages.
+ * The pages are placed on whichever NUMA node the thread that first writes them is running on.
+ */
+template <typename T>
+class PageAllocator {
+public:
+    using value_type = T;
+
+    PageAllocator() noexcept = default;
+    template <typename U>
+    PageAllocator(const PageAllocator<U> &) noexcept {}
+
+    [[nodiscard]] T *allocate(const std::size_t n){
+        if(n > static_cast<std::size_t>(-1) / sizeof(T)){
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T *>(Placement::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *pointer, const std::size_t n) noexcept{
+        Placement::release(pointer, n * sizeof(T));
+    }
+
+    // Default construction leaves the value uninitialised, any other construction is forwarded as usual
+    template <typename U>
+    void construct(U *pointer) noexcept{
+        ::new(static_cast<void *>(pointer)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U *pointer, Args &&... args){
+        ::new(static_cast<void *>(pointer)) U(std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    bool operator==(const PageAllocator<U> &) const noexcept{ return true; }
+    template <typename U>
+    bool operator!=(const PageAllocator<U> &) const noexcept{ return false; }
+};
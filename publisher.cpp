@@ -0,0 +1,336 @@
+/**
+ * Implements a Publisher for sharing live generations through POSIX shared memory, and a Subscriber for reading them.
+ *      - A segment is created with shm_open under the given name, a leading '/' is added if it is missing.
+ *          - The name must be free. A segment already under it, live or left behind by a publisher that crashed,
+ *            is only removed and replaced when the publisher is asked to replace it.
+ *          - A publisher only removes the segment it created. If its name was since taken by a replacement the
+ *            replacement is left alone.
+ *          - The segment starts with a SharedSegment header, padded to 64 bytes.
+ *          - It is followed by SharedSegment::frames frames, each a SharedFrame header and then capacity Cell bytes
+ *            in C-style row/column format, ' ' for Cell::DEAD and '#' for Cell::ALIVE, padded to 64 bytes.
+ *          - All fields are in the host's byte order, the segment is only for readers on the same host.
+ *
+ *      - Frames are written round robin and guarded by a sequence lock.
+ *          - The writer makes the frame's sequence odd, writes the header and cells, then makes it even again.
+ *          - SharedSegment::published is bumped once the frame is complete, the latest frame is (published - 1) % frames.
+ *          - A reader reads the sequence, then the frame, then the sequence again. If it changed, or was odd to
+ *            begin with, the frame was torn and the reader tries again.
+ *          - The writer never waits on a reader, a slow reader only sees torn frames.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "publisher.h"
+
+namespace {
+    std::size_t padded(const std::size_t bytes){
+        return (bytes + 63) / 64 * 64;
+    }
+
+    std::size_t frame_stride(const std::uint64_t capacity){
+        return padded(sizeof(SharedFrame) + capacity);
+    }
+
+    std::string segment_name(const std::string &name){
+        return (!name.empty() && name[0] == '/') ? name : "/" + name;
+    }
+}
+
+/**
+ * Publisher::Publisher(name, width, height, frames = 3, replace = false)
+ *
+ * Create a named shared memory segment with room for frames of up to width x height cells.
+ *
+ * @example
+ *
+ *      // Publish every generation of a world for dashboards to read
+ *      Publisher publisher("gol_live", world.get_width(), world.get_height());
+ *      for(int generation = 0; generation < 100; generation++){
+ *          publisher.publish(world.get_state(), generation);
+ *          world.step();
+ *      }
+ *
+ * @param name
+ *      The name of the segment, as passed to shm_open.
+ *
+ * @param width
+ *      The width of the largest frame.
+ *
+ * @param height
+ *      The height of the largest frame.
+ *
+ * @param frames
+ *      Optional parameter. The number of frames to cycle through, at least 2. Defaults to 3.
+ *
+ * @param replace
+ *      Optional parameter. If true then a segment already under the name, such as one left behind by a crashed
+ *      publisher, is removed and replaced. Readers of the old segment keep its last frames. Defaults to false.
+ *
+ * @throws
+ *      Throws std::runtime_error if the sizes are invalid, the name is taken and not to be replaced, or the segment
+ *      cannot be created.
+ */
+Publisher::Publisher(const std::string &name, const int width, const int height, const int frames,
+                     const bool replace) : name(segment_name(name)){
+    if(width < 0 || height < 0 || frames < 2){
+        throw std::runtime_error("Publisher::Publisher() : Needs a non negative size and at least two frames");
+    }
+    const std::uint64_t capacity = static_cast<std::uint64_t>(width) * static_cast<std::uint64_t>(height);
+    segment_size = padded(sizeof(SharedSegment)) + frame_stride(capacity) * frames;
+
+    int file = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if(file < 0 && errno == EEXIST && replace){
+        shm_unlink(this->name.c_str());
+        file = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if(file < 0 && errno == EEXIST){
+        throw std::runtime_error("Publisher::Publisher() : Shared memory segment " + this->name
+                                 + " already exists, it must be removed or replaced");
+    }
+    if(file < 0){
+        throw std::runtime_error("Publisher::Publisher() : Could not create shared memory segment " + this->name);
+    }
+    struct stat status{};
+    fstat(file, &status);
+    segment_device = static_cast<std::uint64_t>(status.st_dev);
+    segment_inode = static_cast<std::uint64_t>(status.st_ino);
+    if(ftruncate(file, static_cast<off_t>(segment_size)) != 0){
+        close(file);
+        shm_unlink(this->name.c_str());
+        throw std::runtime_error("Publisher::Publisher() : Could not size shared memory segment " + this->name);
+    }
+    void *data = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    close(file);
+    if(data == MAP_FAILED){
+        shm_unlink(this->name.c_str());
+        throw std::runtime_error("Publisher::Publisher() : Could not map shared memory segment " + this->name);
+    }
+
+    // Readers ignore the segment until the magic number is written last
+    std::memset(data, 0, segment_size);
+    segment = new (data) SharedSegment{};
+    segment->frames = static_cast<std::uint32_t>(frames);
+    segment->capacity = capacity;
+    segment->published.store(0);
+    char *frame_data = static_cast<char *>(data) + padded(sizeof(SharedSegment));
+    for(int i = 0; i < frames; i++){
+        new (frame_data + frame_stride(capacity) * i) SharedFrame{};
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    segment->magic = SharedSegment::MAGIC;
+}
+
+/**
+ * Publisher::~Publisher()
+ *
+ * Unmap the segment and remove it, unless its name has since been taken by a replacement. Readers that already
+ * mapped it keep the last frames.
+ */
+Publisher::~Publisher(){
+    if(segment != nullptr){
+        munmap(segment, segment_size);
+        const int file = shm_open(name.c_str(), O_RDONLY, 0);
+        if(file >= 0){
+            struct stat status{};
+            const bool own = fstat(file, &status) == 0
+                             && static_cast<std::uint64_t>(status.st_dev) == segment_device
+                             && static_cast<std::uint64_t>(status.st_ino) == segment_inode;
+            close(file);
+            if(own){
+                shm_unlink(name.c_str());
+            }
+        }
+    }
+}
+
+/**
+ * Publisher::publish(state, generation)
+ *
+ * Copy a state into the oldest frame and make it the latest one. Never waits on readers.
+ *
+ * @param state
+ *      The cells to publish, which must fit the size the segment was created with.
+ *
+ * @param generation
+ *      The generation number to label the frame with.
+ *
+ * @throws
+ *      Throws std::runtime_error if the state has more cells than a frame can hold.
+ */
+void Publisher::publish(const GridView &state, const std::int64_t generation){
+    const int width = state.get_width();
+    const int height = state.get_height();
+    if(static_cast<std::uint64_t>(state.get_total_cells()) > segment->capacity){
+        throw std::runtime_error("Publisher::publish() : The state is larger than the shared memory frames");
+    }
+
+    const std::uint64_t published = segment->published.load(std::memory_order_relaxed);
+    char *frame_data = reinterpret_cast<char *>(segment) + padded(sizeof(SharedSegment))
+                       + frame_stride(segment->capacity) * (published % segment->frames);
+    auto *frame = reinterpret_cast<SharedFrame *>(frame_data);
+    Cell *cells = reinterpret_cast<Cell *>(frame_data + sizeof(SharedFrame));
+
+    // Odd while the frame is being written
+    const std::uint64_t sequence = frame->sequence.load(std::memory_order_relaxed);
+    frame->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    frame->generation = generation;
+    frame->width = width;
+    frame->height = height;
+    frame->population = state.get_alive_cells();
+    if(width > 0){
+        for(int y = 0; y < height; y++){
+            std::memcpy(cells + static_cast<std::size_t>(y) * width, &state(0, y), width);
+        }
+    }
+
+    frame->sequence.store(sequence + 2, std::memory_order_release);
+    segment->published.store(published + 1, std::memory_order_release);
+}
+
+/**
+ * Publisher::get_published()
+ *
+ * @return
+ *      How many frames have been published.
+ */
+std::uint64_t Publisher::get_published() const{
+    return segment->published.load(std::memory_order_relaxed);
+}
+
+/**
+ * Subscriber::Subscriber(name)
+ *
+ * Map a segment made by a Publisher for reading.
+ *
+ * @example
+ *
+ *      // Follow the live state of a running simulation
+ *      Subscriber subscriber("gol_live");
+ *      Grid latest;
+ *      FrameInfo info;
+ *      if(subscriber.read(latest, info)){
+ *          std::cout << "Generation " << info.generation << std::endl << latest << std::endl;
+ *      }
+ *
+ * @param name
+ *      The name of the segment, as passed to the Publisher.
+ *
+ * @throws
+ *      Throws std::runtime_error if the segment does not exist or is not ready.
+ */
+Subscriber::Subscriber(const std::string &name){
+    const std::string full_name = segment_name(name);
+    const int file = shm_open(full_name.c_str(), O_RDONLY, 0);
+    if(file < 0){
+        throw std::runtime_error("Subscriber::Subscriber() : Could not open shared memory segment " + full_name);
+    }
+    const off_t size = lseek(file, 0, SEEK_END);
+    void *data = (size >= static_cast<off_t>(sizeof(SharedSegment)))
+                 ? mmap(nullptr, static_cast<std::size_t>(size), PROT_READ, MAP_SHARED, file, 0) : MAP_FAILED;
+    close(file);
+    if(data == MAP_FAILED){
+        throw std::runtime_error("Subscriber::Subscriber() : Could not map shared memory segment " + full_name);
+    }
+    segment = static_cast<const SharedSegment *>(data);
+    segment_size = static_cast<std::size_t>(size);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(segment->magic != SharedSegment::MAGIC || segment->frames < 2
+       || padded(sizeof(SharedSegment)) + frame_stride(segment->capacity) * segment->frames > segment_size){
+        munmap(const_cast<SharedSegment *>(segment), segment_size);
+        segment = nullptr;
+        throw std::runtime_error("Subscriber::Subscriber() : Not a ready shared memory segment " + full_name);
+    }
+}
+
+/**
+ * Subscriber::~Subscriber()
+ *
+ * Unmap the segment.
+ */
+Subscriber::~Subscriber(){
+    if(segment != nullptr){
+        munmap(const_cast<SharedSegment *>(segment), segment_size);
+    }
+}
+
+/**
+ * Subscriber::latest_frame()
+ *
+ * Private helper to find the most recently published frame.
+ *
+ * @return
+ *      The latest frame, or nullptr if nothing has been published yet.
+ */
+const SharedFrame *Subscriber::latest_frame() const{
+    const std::uint64_t published = segment->published.load(std::memory_order_acquire);
+    if(published == 0){
+        return nullptr;
+    }
+    const char *frame_data = reinterpret_cast<const char *>(segment) + padded(sizeof(SharedSegment))
+                             + frame_stride(segment->capacity) * ((published - 1) % segment->frames);
+    return reinterpret_cast<const SharedFrame *>(frame_data);
+}
+
+/**
+ * Subscriber::frame_view(frame)
+ *
+ * Private helper to view the cells of a frame in place.
+ *
+ * @param frame
+ *      The frame, whose width and height have been checked against the segment's capacity.
+ *
+ * @return
+ *      A view of the frame's cells.
+ */
+GridView Subscriber::frame_view(const SharedFrame *frame){
+    const Cell *cells = reinterpret_cast<const Cell *>(reinterpret_cast<const char *>(frame) + sizeof(SharedFrame));
+    return GridView(cells, frame->width, frame->height, frame->width);
+}
+
+/**
+ * Subscriber::read(output, info, attempts = 16)
+ *
+ * Copy the latest frame out of the segment, trying again if the writer tears it.
+ *
+ * @param output
+ *      The grid to copy the frame into, resized to fit.
+ *
+ * @param info
+ *      Set to the frame's generation, size and population.
+ *
+ * @param attempts
+ *      Optional parameter. How many times to try before giving up. Defaults to 16.
+ *
+ * @return
+ *      True if a whole frame was copied, false if nothing has been published or every attempt was torn.
+ */
+bool Subscriber::read(Grid &output, FrameInfo &info, const int attempts) const{
+    for(int attempt = 0; attempt < attempts; attempt++){
+        FrameInfo seen;
+        const bool whole = visit([&output, &seen](const GridView &view, const FrameInfo &frame_info){
+            seen = frame_info;
+            output.resize(view.get_width(), view.get_height());
+            output.merge(view, 0, 0);
+        });
+        if(whole){
+            info = seen;
+            return true;
+        }
+        if(segment->published.load(std::memory_order_acquire) == 0){
+            return false;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,141 @@
+/**
+ * Declares a Publisher for sharing live generations through POSIX shared memory, and a Subscriber for reading them.
+ * Rich documentation for the api, behaviour and segment layout can be found in publisher.cpp.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "grid.h"
+
+/**
+ * The header at the start of a shared memory segment.
+ */
+struct SharedSegment {
+    std::uint32_t magic; // SharedSegment::MAGIC once the segment is ready
+    std::uint32_t frames; // The number of frames the segment cycles through
+    std::uint64_t capacity; // The most cells a frame can hold
+    alignas(64) std::atomic<std::uint64_t> published; // How many frames have been published
+
+    static constexpr std::uint32_t MAGIC = 0x4c4f4721; // "!GOL"
+};
+
+/**
+ * The header of one frame in a shared memory segment, followed by its cells.
+ * The sequence is odd while the frame is being written and even once it is complete.
+ */
+struct SharedFrame {
+    alignas(64) std::atomic<std::uint64_t> sequence;
+    std::int64_t generation;
+    std::int32_t width;
+    std::int32_t height;
+    std::int64_t population;
+};
+
+/**
+ * What a Subscriber read about a frame.
+ */
+struct FrameInfo {
+    std::int64_t generation = -1;
+    int width = 0;
+    int height = 0;
+    std::int64_t population = 0;
+};
+
+/**
+ * Declare the structure of the Publisher class, the writing side of a shared memory segment.
+ *
+ * Publishing never waits for readers, it overwrites the oldest frame.
+ */
+class Publisher {
+private:
+    std::string name;
+    SharedSegment *segment = nullptr;
+    std::size_t segment_size = 0;
+    std::uint64_t segment_device = 0; // Identifies the segment this publisher created, so it never removes another
+    std::uint64_t segment_inode = 0;
+public:
+    Publisher(const std::string &name, int width, int height, int frames = 3, bool replace = false);
+    Publisher(const Publisher &other) = delete;
+    Publisher& operator=(const Publisher &other) = delete;
+    ~Publisher();
+
+    void publish(const GridView &state, std::int64_t generation);
+    [[nodiscard]] std::uint64_t get_published() const;
+};
+
+/**
+ * Declare the structure of the Subscriber class, the reading side of a shared memory segment.
+ *
+ * Readers map the segment read only and look at the latest frame in place.
+ */
+class Subscriber {
+private:
+    const SharedSegment *segment = nullptr;
+    std::size_t segment_size = 0;
+    [[nodiscard]] const SharedFrame *latest_frame() const;
+    [[nodiscard]] static GridView frame_view(const SharedFrame *frame);
+public:
+    explicit Subscriber(const std::string &name);
+    Subscriber(const Subscriber &other) = delete;
+    Subscriber& operator=(const Subscriber &other) = delete;
+    ~Subscriber();
+
+    template <typename Visit>
+    bool visit(Visit visit) const;
+    bool read(Grid &output, FrameInfo &info, int attempts = 16) const;
+};
+
+/**
+ * Subscriber::visit(visit)
+ *
+ * Look at the latest frame in place, without copying it. The frame can be overwritten while visit runs, so anything
+ * worked out from it must be thrown away if this returns false. Triple buffering gives a reader two publications'
+ * worth of time before the frame it is looking at is reused.
+ *
+ * @example
+ *
+ *      // Count the alive cells in the top left corner of the latest frame
+ *      std::int64_t alive = 0;
+ *      const bool valid = subscriber.visit([&](const GridView &view, const FrameInfo &info){
+ *          alive = view.view(0, 0, 64, 64).get_alive_cells();
+ *      });
+ *
+ * @tparam Visit
+ *      A callable taking the frame as a const GridView& and its details as a const FrameInfo&.
+ *
+ * @param visit
+ *      The work to do on the frame.
+ *
+ * @return
+ *      True if the frame was left untouched while it was visited, false if there is no frame yet or it was torn.
+ */
+template <typename Visit>
+bool Subscriber::visit(Visit visit) const{
+    const SharedFrame *frame = latest_frame();
+    if(frame == nullptr){
+        return false;
+    }
+    const std::uint64_t before = frame->sequence.load(std::memory_order_acquire);
+    if(before % 2 != 0){
+        return false;
+    }
+
+    FrameInfo info;
+    info.generation = frame->generation;
+    info.width = frame->width;
+    info.height = frame->height;
+    info.population = frame->population;
+    if(static_cast<std::uint64_t>(info.width) * static_cast<std::uint64_t>(info.height) > segment->capacity){
+        return false; // A torn header, the cells cannot be looked at
+    }
+    visit(frame_view(frame), info);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return frame->sequence.load(std::memory_order_relaxed) == before;
+}
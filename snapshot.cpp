@@ -0,0 +1,244 @@
+/**
+ * Implements a class holding a copy on write snapshot of a world's cells, split into reference counted tiles.
+ *      - The cells are cut into TILE_SIZE x TILE_SIZE tiles, smaller along the right and bottom edges.
+ *          - Each tile is its own reference counted block of cells and is never written once made.
+ *
+ *      - A snapshot taken against a base snapshot of the same size shares every tile whose cells are unchanged.
+ *          - Taking it still reads the whole grid to find the changed tiles, but only the changed tiles are copied
+ *            and only they cost memory.
+ *          - Copying a snapshot copies the tile pointers, never the cells.
+ *
+ *      - Writing a snapshot back into a grid can skip the tiles it shares with a snapshot the grid is known to hold,
+ *        so rolling back to a recent snapshot only writes the tiles that differ.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "snapshot.h"
+
+/**
+ * Snapshot::Snapshot(state)
+ *
+ * Take a snapshot of a grid, copying every tile.
+ *
+ * @example
+ *
+ *      // Keep the current state of a world
+ *      Snapshot before(world.get_state());
+ *
+ * @param state
+ *      The cells to copy, a grid or a view of part of one.
+ */
+Snapshot::Snapshot(const GridView &state) : Snapshot(state, Snapshot()){}
+
+/**
+ * Snapshot::Snapshot(state, base)
+ *
+ * Take a snapshot of a grid, sharing the tiles that are unchanged since an earlier snapshot.
+ * Nothing is shared if the base is a different size.
+ *
+ * @example
+ *
+ *      // Keep two generations of a world, the second only copies the tiles that changed
+ *      Snapshot first(world.get_state());
+ *      world.step();
+ *      Snapshot second(world.get_state(), first);
+ *
+ * @param state
+ *      The cells to copy, a grid or a view of part of one.
+ *
+ * @param base
+ *      An earlier snapshot to share tiles with.
+ */
+Snapshot::Snapshot(const GridView &state, const Snapshot &base) : width(state.get_width()), height(state.get_height()){
+    const int across = get_tiles_across();
+    const int down = (height + TILE_SIZE - 1) / TILE_SIZE;
+    const std::size_t count = static_cast<std::size_t>(across) * down;
+    const bool shareable = base.width == width && base.height == height && base.tiles.size() == count;
+    tiles.reserve(count);
+
+    for(int ty = 0; ty < down; ty++){
+        for(int tx = 0; tx < across; tx++){
+            const int x0 = tx * TILE_SIZE;
+            const int y0 = ty * TILE_SIZE;
+            const int tile_width = std::min(TILE_SIZE, width - x0);
+            const int tile_height = std::min(TILE_SIZE, height - y0);
+
+            // Keep the base's tile if every row still matches
+            if(shareable){
+                const Tile &old = base.tiles[tiles.size()];
+                bool unchanged = true;
+                for(int y = 0; y < tile_height && unchanged; y++){
+                    unchanged = std::memcmp(old->data() + static_cast<std::size_t>(y) * tile_width,
+                                            &state(x0, y0 + y), tile_width) == 0;
+                }
+                if(unchanged){
+                    tiles.push_back(old);
+                    continue;
+                }
+            }
+
+            auto tile = std::make_shared<std::vector<Cell>>(static_cast<std::size_t>(tile_width) * tile_height);
+            for(int y = 0; y < tile_height; y++){
+                std::memcpy(tile->data() + static_cast<std::size_t>(y) * tile_width, &state(x0, y0 + y), tile_width);
+            }
+            tiles.push_back(std::move(tile));
+        }
+    }
+}
+
+/**
+ * Snapshot::get_width()
+ *
+ * @return
+ *      The width of the snapshot.
+ */
+int Snapshot::get_width() const{
+    return width;
+}
+
+/**
+ * Snapshot::get_height()
+ *
+ * @return
+ *      The height of the snapshot.
+ */
+int Snapshot::get_height() const{
+    return height;
+}
+
+/**
+ * Snapshot::get_tile_count()
+ *
+ * @return
+ *      The number of tiles the snapshot is cut into.
+ */
+std::size_t Snapshot::get_tile_count() const{
+    return tiles.size();
+}
+
+/**
+ * Snapshot::count_shared(other)
+ *
+ * Count the tiles two snapshots share rather than each holding their own copy.
+ *
+ * @example
+ *
+ *      // See how much of a branch is still shared with the snapshot it was forked from
+ *      std::size_t copied = branch.get_tile_count() - branch.count_shared(root);
+ *
+ * @param other
+ *      The snapshot to compare with.
+ *
+ * @return
+ *      The number of tiles in the same place held by both, 0 if the snapshots are different sizes.
+ */
+std::size_t Snapshot::count_shared(const Snapshot &other) const{
+    if(!same_shape(other)){
+        return 0;
+    }
+    std::size_t shared = 0;
+    for(std::size_t i = 0; i < tiles.size(); i++){
+        shared += (tiles[i] == other.tiles[i]) ? 1 : 0;
+    }
+    return shared;
+}
+
+/**
+ * Snapshot::to_grid()
+ *
+ * @return
+ *      A new grid holding the snapshot's cells.
+ */
+Grid Snapshot::to_grid() const{
+    Grid output(width, height);
+    write_to(output);
+    return output;
+}
+
+/**
+ * Snapshot::write_to(output)
+ *
+ * Copy every tile into a grid of the same size.
+ *
+ * @param output
+ *      The grid to write.
+ *
+ * @throws
+ *      Throws std::runtime_error if the grid is not the same size as the snapshot.
+ */
+void Snapshot::write_to(Grid &output) const{
+    write_to(output, Snapshot());
+}
+
+/**
+ * Snapshot::write_to(output, known)
+ *
+ * Copy the snapshot into a grid that is known to hold another snapshot, skipping the tiles the two share.
+ *
+ * @example
+ *
+ *      // Roll a grid holding the state of after back to before, only writing the tiles that changed
+ *      before.write_to(grid, after);
+ *
+ * @param output
+ *      The grid to write.
+ *
+ * @param known
+ *      A snapshot whose cells the grid holds. Every tile is written if it is a different size.
+ *
+ * @throws
+ *      Throws std::runtime_error if the grid is not the same size as the snapshot.
+ */
+void Snapshot::write_to(Grid &output, const Snapshot &known) const{
+    if(output.get_width() != width || output.get_height() != height){
+        throw std::runtime_error("Snapshot::write_to() : The grid is not the same size as the snapshot");
+    }
+    const int across = get_tiles_across();
+    const bool skip_shared = same_shape(known);
+
+    for(std::size_t i = 0; i < tiles.size(); i++){
+        if(skip_shared && tiles[i] == known.tiles[i]){
+            continue;
+        }
+        const int x0 = static_cast<int>(i % across) * TILE_SIZE;
+        const int y0 = static_cast<int>(i / across) * TILE_SIZE;
+        const int tile_width = std::min(TILE_SIZE, width - x0);
+        const int tile_height = std::min(TILE_SIZE, height - y0);
+        for(int y = 0; y < tile_height; y++){
+            std::memcpy(&output(x0, y0 + y), tiles[i]->data() + static_cast<std::size_t>(y) * tile_width, tile_width);
+        }
+    }
+}
+
+/**
+ * Snapshot::get_tiles_across()
+ *
+ * Private helper for the number of tiles in each row of tiles.
+ *
+ * @return
+ *      The number of tiles across the width.
+ */
+int Snapshot::get_tiles_across() const{
+    return (width + TILE_SIZE - 1) / TILE_SIZE;
+}
+
+/**
+ * Snapshot::same_shape(other)
+ *
+ * Private helper to check two snapshots cut their cells into the same tiles.
+ *
+ * @param other
+ *      The snapshot to compare with.
+ *
+ * @return
+ *      True if the snapshots are the same size and both hold their tiles.
+ */
+bool Snapshot::same_shape(const Snapshot &other) const{
+    return other.width == width && other.height == height && other.tiles.size() == tiles.size()
+           && !tiles.empty();
+}
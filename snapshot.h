@@ -0,0 +1,48 @@
+/**
+ * Declares a class holding a copy on write snapshot of a world's cells, split into reference counted tiles.
+ * Rich documentation for the api and behaviour the Snapshot class can be found in snapshot.cpp.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "grid.h"
+
+/**
+ * Declare the structure of the Snapshot class, an immutable tiled copy of a grid.
+ *
+ * Tiles are never written once made, so snapshots taken from one another share every tile that did not change
+ * between them, and copying a snapshot only copies the tile pointers.
+ */
+class Snapshot {
+private:
+    using Tile = std::shared_ptr<const std::vector<Cell>>;
+
+    int width = 0;
+    int height = 0;
+    std::vector<Tile> tiles; // Row major, each tile holds its rows back to back
+    [[nodiscard]] int get_tiles_across() const;
+    [[nodiscard]] bool same_shape(const Snapshot &other) const;
+public:
+    static constexpr int TILE_SIZE = 64;
+
+    // Constructors & destructors
+    Snapshot() = default;
+    explicit Snapshot(const GridView &state);
+    Snapshot(const GridView &state, const Snapshot &base);
+
+    // Getters
+    [[nodiscard]] int get_width() const;
+    [[nodiscard]] int get_height() const;
+    [[nodiscard]] std::size_t get_tile_count() const;
+    [[nodiscard]] std::size_t count_shared(const Snapshot &other) const;
+
+    // Other Functions
+    [[nodiscard]] Grid to_grid() const;
+    void write_to(Grid &output) const;
+    void write_to(Grid &output, const Snapshot &known) const;
+};
@@ -0,0 +1,512 @@
+/**
+ * Implements a server that keeps many worlds resident and steps them on behalf of clients over a unix domain socket.
+ *      - Requests are single text lines, replies start with "OK" or "ERR <message>" on their own line.
+ *          - CREATE <width> <height>, followed by (height) lines of (width) characters in the ascii .gol style,
+ *            ' ' for Cell::DEAD and '#' for Cell::ALIVE. Replies OK <id>. A CREATE that fails closes the connection
+ *            after its ERR reply, as the rows left unread could not be told apart from requests. Worlds larger
+ *            than the server's cell limit are refused before anything is allocated.
+ *          - ADVANCE <id> <steps> [toroidal], toroidal is 0 or 1 and defaults to 0. Replies OK <population>.
+ *          - POPULATION <id>. Replies OK <population>.
+ *          - CROP <id> <x0> <y0> <x1> <y1>. Replies OK <width> <height>, followed by the rows in the CREATE format.
+ *          - STATE <id>. Replies as CROP over the whole world.
+ *          - DESTROY <id>. Replies OK.
+ *
+ *      - Each client connection is read by its own thread, requests on one connection are answered in order.
+ *      - Worlds stay resident between requests, so their next state buffers are reused for every step.
+ *          - The grids of destroyed worlds are kept and resized for new worlds, up to a limit.
+ *      - ADVANCE requests are queued for a pool of worker threads rather than stepped on the connection's thread.
+ *          - A worker takes its share of the queued requests, the queue split evenly between the workers and up
+ *            to a batch limit, each time it wakes up. Many small boards share one wake up instead of paying for
+ *            one each, while a burst of requests still spreads over the pool.
+ *          - Requests for the same world from different connections take turns through the world's lock.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "step_server.h"
+
+namespace {
+    constexpr std::size_t BATCH_LIMIT = 64;
+    constexpr std::size_t SPARE_LIMIT = 64;
+    constexpr std::size_t LINE_LIMIT = 1 << 16;
+
+    bool write_all(const int socket, const std::string &data){
+        const char *bytes = data.data();
+        std::size_t size = data.size();
+        while(size > 0){
+            const ssize_t written = send(socket, bytes, size, MSG_NOSIGNAL);
+            if(written <= 0){
+                return false;
+            }
+            bytes += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    void write_rows(std::ostringstream &reply, const GridView &view){
+        reply << "OK " << view.get_width() << ' ' << view.get_height() << '\n';
+        for(int y = 0; y < view.get_height(); y++){
+            for(int x = 0; x < view.get_width(); x++){
+                reply << static_cast<char>(view(x, y));
+            }
+            reply << '\n';
+        }
+    }
+}
+
+/**
+ * Declare the structure of the LineReader class, a buffered reader of lines and fixed size blocks from a socket.
+ */
+class StepServer::LineReader {
+private:
+    int socket;
+    std::string buffer;
+    std::size_t start = 0;
+    bool closed = false;
+
+    bool fill(){
+        if(start > 0){
+            buffer.erase(0, start);
+            start = 0;
+        }
+        char chunk[4096];
+        const ssize_t got = read(socket, chunk, sizeof(chunk));
+        if(got <= 0){
+            return false;
+        }
+        buffer.append(chunk, static_cast<std::size_t>(got));
+        return true;
+    }
+public:
+    explicit LineReader(const int socket) : socket(socket){}
+
+    // Read up to the next newline, which is dropped. False once the connection closes or a line is too long.
+    bool read_line(std::string &line){
+        if(closed){
+            return false;
+        }
+        std::size_t end;
+        while((end = buffer.find('\n', start)) == std::string::npos){
+            if(buffer.size() - start > LINE_LIMIT || !fill()){
+                return false;
+            }
+        }
+        line.assign(buffer, start, end - start);
+        start = end + 1;
+        return true;
+    }
+
+    // Stop reading, the connection is out of step with the protocol
+    void close(){
+        closed = true;
+    }
+};
+
+/**
+ * StepServer::StepServer(socket_path, threads = 0, max_cells = 2^28)
+ *
+ * Start listening on a unix domain socket and start the step workers. Clients are not served until StepServer::run.
+ * A stale socket file left at the path by an earlier server is replaced.
+ *
+ * @example
+ *
+ *      // Serve worlds until stopped
+ *      StepServer server("/tmp/gol.sock");
+ *      server.run();
+ *
+ * @param socket_path
+ *      The path of the socket file to listen on.
+ *
+ * @param threads
+ *      Optional parameter. The number of step workers. Defaults to 0, one per hardware thread.
+ *
+ * @param max_cells
+ *      Optional parameter. The most cells a client may CREATE a world with. Defaults to 2^28, 256MB per world.
+ *
+ * @throws
+ *      Throws std::runtime_error if the socket cannot be opened.
+ */
+StepServer::StepServer(const std::string &socket_path, const int threads, const std::int64_t max_cells)
+    : socket_path(socket_path), max_cells(max_cells){
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if(socket_path.empty() || socket_path.size() >= sizeof(address.sun_path)){
+        throw std::runtime_error("StepServer::StepServer() : Not a valid socket path " + socket_path);
+    }
+    std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listener < 0){
+        throw std::runtime_error("StepServer::StepServer() : Could not open a socket");
+    }
+    unlink(socket_path.c_str());
+    if(bind(listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 || listen(listener, 64) != 0){
+        close(listener);
+        throw std::runtime_error("StepServer::StepServer() : Could not listen on " + socket_path);
+    }
+
+    const int count = (threads > 0) ? threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    for(int i = 0; i < count; i++){
+        workers.emplace_back(&StepServer::work, this);
+    }
+}
+
+/**
+ * StepServer::~StepServer()
+ *
+ * Stop serving, wait for the client and worker threads, and remove the socket file.
+ * A thread still inside StepServer::run must have returned first.
+ */
+StepServer::~StepServer(){
+    stop();
+
+    // Client threads finish once their connections are shut down, take the threads out before joining them.
+    // The workers keep going until then, a client may still be waiting on a step.
+    std::vector<std::thread> remaining;
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        for(auto &client : clients){
+            remaining.push_back(std::move(client.second));
+        }
+        clients.clear();
+        for(std::thread &client : finished_clients){
+            remaining.push_back(std::move(client));
+        }
+        finished_clients.clear();
+    }
+    for(std::thread &client : remaining){
+        client.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        jobs_closed = true;
+    }
+    jobs_ready.notify_all();
+    for(std::thread &worker : workers){
+        worker.join();
+    }
+    close(listener);
+    unlink(socket_path.c_str());
+}
+
+/**
+ * StepServer::run()
+ *
+ * Accept and serve clients until StepServer::stop is called. Each client gets its own thread.
+ */
+void StepServer::run(){
+    while(!stopping){
+        const int client = accept(listener, nullptr, nullptr);
+        if(client < 0){
+            if(stopping){
+                break;
+            }
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        for(std::thread &finished : finished_clients){
+            finished.join();
+        }
+        finished_clients.clear();
+        if(stopping){
+            close(client);
+            break;
+        }
+        clients.emplace(client, std::thread(&StepServer::serve, this, client));
+    }
+}
+
+/**
+ * StepServer::stop()
+ *
+ * Stop accepting clients and close every open connection. Can be called from any thread.
+ */
+void StepServer::stop(){
+    if(stopping.exchange(true)){
+        return;
+    }
+    shutdown(listener, SHUT_RDWR);
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    for(const auto &client : clients){
+        shutdown(client.first, SHUT_RDWR);
+    }
+}
+
+/**
+ * StepServer::get_world_count()
+ *
+ * @return
+ *      The number of worlds currently resident.
+ */
+std::size_t StepServer::get_world_count(){
+    std::lock_guard<std::mutex> lock(worlds_mutex);
+    return worlds.size();
+}
+
+/**
+ * StepServer::work()
+ *
+ * Private helper holding the loop each step worker runs. Takes its share of the queued step requests at a time and
+ * answers each with the world's population once it has been stepped.
+ */
+void StepServer::work(){
+    std::vector<std::unique_ptr<Job>> batch;
+    while(true){
+        {
+            std::unique_lock<std::mutex> lock(jobs_mutex);
+            jobs_ready.wait(lock, [this](){ return jobs_closed || !jobs.empty(); });
+            if(jobs.empty()){
+                return;
+            }
+            // Leave the rest of the queue to the other workers so a burst is stepped in parallel
+            const std::size_t share = std::min(BATCH_LIMIT, (jobs.size() + workers.size() - 1) / workers.size());
+            while(!jobs.empty() && batch.size() < share){
+                batch.push_back(std::move(jobs.front()));
+                jobs.pop_front();
+            }
+            if(!jobs.empty()){
+                jobs_ready.notify_one();
+            }
+        }
+
+        for(std::unique_ptr<Job> &job : batch){
+            try {
+                std::lock_guard<std::mutex> lock(job->entry->mutex);
+                job->entry->world.advance(job->steps, job->toroidal);
+                job->done.set_value(job->entry->world.get_alive_cells());
+            }
+            catch (...) {
+                job->done.set_exception(std::current_exception());
+            }
+        }
+        batch.clear();
+    }
+}
+
+/**
+ * StepServer::serve(client)
+ *
+ * Private helper holding the loop each client thread runs, answering requests until the connection closes.
+ *
+ * @param client
+ *      The connected socket.
+ */
+void StepServer::serve(const int client){
+    LineReader reader(client);
+    std::string request;
+    while(!stopping && reader.read_line(request)){
+        std::string reply;
+        try {
+            reply = handle(request, reader);
+        }
+        catch (const std::exception &ex) {
+            reply = std::string("ERR ") + ex.what() + "\n";
+        }
+        if(!write_all(client, reply)){
+            break;
+        }
+    }
+
+    // Hand this thread to the accept loop to be joined
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    const auto found = clients.find(client);
+    if(found != clients.end()){
+        finished_clients.push_back(std::move(found->second));
+        clients.erase(found);
+    }
+    close(client);
+}
+
+/**
+ * StepServer::handle(request, reader)
+ *
+ * Private helper that answers one request.
+ *
+ * @param request
+ *      The request line.
+ *
+ * @param reader
+ *      The connection's reader, for requests followed by rows of cells.
+ *
+ * @return
+ *      The full reply, ending in a newline.
+ *
+ * @throws
+ *      Throws std::runtime_error if the request is not valid, the message is sent back to the client.
+ */
+std::string StepServer::handle(const std::string &request, LineReader &reader){
+    std::istringstream fields(request);
+    std::string command;
+    fields >> command;
+    std::ostringstream reply;
+
+    if(command == "CREATE"){
+        Grid state;
+        try {
+            int width = -1;
+            int height = -1;
+            if(!(fields >> width >> height) || width < 0 || height < 0){
+                throw std::runtime_error("StepServer::handle() : CREATE needs a width and height");
+            }
+            if(static_cast<std::size_t>(width) > LINE_LIMIT){
+                throw std::runtime_error("StepServer::handle() : CREATE rows are limited to "
+                                         + std::to_string(LINE_LIMIT) + " cells");
+            }
+            if(static_cast<std::int64_t>(width) * height > max_cells){
+                throw std::runtime_error("StepServer::handle() : CREATE worlds are limited to "
+                                         + std::to_string(max_cells) + " cells");
+            }
+            state = spare_grid(width, height);
+            std::string row;
+            for(int y = 0; y < height; y++){
+                if(!reader.read_line(row) || static_cast<int>(row.size()) != width){
+                    throw std::runtime_error("StepServer::handle() : CREATE expected " + std::to_string(height)
+                                             + " rows of " + std::to_string(width) + " cells");
+                }
+                for(int x = 0; x < width; x++){
+                    if(row[x] != Cell::ALIVE && row[x] != Cell::DEAD){
+                        throw std::runtime_error("StepServer::handle() : Unknown cell character");
+                    }
+                    state(x, y) = static_cast<Cell>(row[x]);
+                }
+            }
+        }
+        catch (...) {
+            reader.close();
+            throw;
+        }
+
+        auto entry = std::make_shared<Entry>();
+        entry->world.replace_state(std::move(state));
+        std::lock_guard<std::mutex> lock(worlds_mutex);
+        const std::int64_t id = next_id++;
+        worlds.emplace(id, std::move(entry));
+        reply << "OK " << id << '\n';
+        return reply.str();
+    }
+
+    std::int64_t id = 0;
+    if(!(fields >> id)){
+        throw std::runtime_error("StepServer::handle() : " + command + " needs a world id");
+    }
+
+    if(command == "ADVANCE"){
+        int steps = 0;
+        int toroidal = 0;
+        if(!(fields >> steps) || steps < 0){
+            throw std::runtime_error("StepServer::handle() : ADVANCE needs a number of steps");
+        }
+        fields >> toroidal;
+
+        auto job = std::make_unique<Job>();
+        job->entry = find(id);
+        job->steps = steps;
+        job->toroidal = toroidal != 0;
+        std::future<std::int64_t> done = job->done.get_future();
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex);
+            jobs.push_back(std::move(job));
+        }
+        jobs_ready.notify_one();
+        reply << "OK " << done.get() << '\n';
+    } else if(command == "POPULATION"){
+        const std::shared_ptr<Entry> entry = find(id);
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        reply << "OK " << entry->world.get_alive_cells() << '\n';
+    } else if(command == "CROP" || command == "STATE"){
+        const std::shared_ptr<Entry> entry = find(id);
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        const Grid &state = entry->world.get_state();
+        int x0 = 0, y0 = 0, x1 = state.get_width(), y1 = state.get_height();
+        if(command == "CROP" && !(fields >> x0 >> y0 >> x1 >> y1)){
+            throw std::runtime_error("StepServer::handle() : CROP needs x0 y0 x1 y1");
+        }
+        write_rows(reply, state.view(x0, y0, x1, y1));
+    } else if(command == "DESTROY"){
+        std::unique_lock<std::mutex> lock(worlds_mutex);
+        const auto found = worlds.find(id);
+        if(found == worlds.end()){
+            throw std::runtime_error("StepServer::handle() : No world with id " + std::to_string(id));
+        }
+        std::shared_ptr<Entry> entry = std::move(found->second);
+        worlds.erase(found);
+        lock.unlock();
+
+        // Wait out any step still using the world before taking its storage
+        Grid storage;
+        {
+            std::lock_guard<std::mutex> entry_lock(entry->mutex);
+            storage = entry->world.take_state();
+        }
+        lock.lock();
+        if(spare_grids.size() < SPARE_LIMIT){
+            spare_grids.push_back(std::move(storage));
+        }
+        reply << "OK\n";
+    } else {
+        throw std::runtime_error("StepServer::handle() : Unknown command " + command);
+    }
+    return reply.str();
+}
+
+/**
+ * StepServer::find(id)
+ *
+ * Private helper to look up a world.
+ *
+ * @param id
+ *      The world's id.
+ *
+ * @return
+ *      The world, kept alive by the pointer even if it is destroyed meanwhile.
+ *
+ * @throws
+ *      Throws std::runtime_error if there is no world with that id.
+ */
+std::shared_ptr<StepServer::Entry> StepServer::find(const std::int64_t id){
+    std::lock_guard<std::mutex> lock(worlds_mutex);
+    const auto found = worlds.find(id);
+    if(found == worlds.end()){
+        throw std::runtime_error("StepServer::find() : No world with id " + std::to_string(id));
+    }
+    return found->second;
+}
+
+/**
+ * StepServer::spare_grid(width, height)
+ *
+ * Private helper that finds storage for a new world, reusing a destroyed world's grid where there is one.
+ *
+ * @param width
+ *      The width of the new world.
+ *
+ * @param height
+ *      The height of the new world.
+ *
+ * @return
+ *      A grid of the right size. Its cells are not cleared, the caller sets every one.
+ */
+Grid StepServer::spare_grid(const int width, const int height){
+    {
+        std::lock_guard<std::mutex> lock(worlds_mutex);
+        if(!spare_grids.empty()){
+            Grid grid = std::move(spare_grids.back());
+            spare_grids.pop_back();
+            grid.resize(width, height);
+            return grid;
+        }
+    }
+    return Grid(width, height);
+}
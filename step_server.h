@@ -0,0 +1,80 @@
+/**
+ * Declares a server that keeps many worlds resident and steps them on behalf of clients over a unix domain socket.
+ * Rich documentation for the api, behaviour and protocol can be found in step_server.cpp.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "grid.h"
+#include "world.h"
+
+/**
+ * Declare the structure of the StepServer class, a long running host for worlds.
+ *
+ * Client connections are served by their own threads, while the stepping itself is handed to a shared pool of
+ * workers that takes queued step requests in batches.
+ */
+class StepServer {
+private:
+    class LineReader;
+
+    struct Entry {
+        std::mutex mutex; // Held while the world is read or stepped
+        World world;
+    };
+
+    struct Job {
+        std::shared_ptr<Entry> entry;
+        int steps;
+        bool toroidal;
+        std::promise<std::int64_t> done; // The population after the steps
+    };
+
+    std::string socket_path;
+    std::int64_t max_cells; // The largest world a client may create
+    int listener = -1;
+    std::atomic<bool> stopping{false};
+
+    std::mutex worlds_mutex;
+    std::map<std::int64_t, std::shared_ptr<Entry>> worlds;
+    std::int64_t next_id = 1;
+    std::vector<Grid> spare_grids; // Storage from destroyed worlds, reused for new ones
+
+    std::mutex jobs_mutex;
+    std::condition_variable jobs_ready;
+    std::deque<std::unique_ptr<Job>> jobs;
+    bool jobs_closed = false; // Set once no more jobs can arrive, the workers finish the queue and return
+    std::vector<std::thread> workers;
+
+    std::mutex clients_mutex;
+    std::map<int, std::thread> clients;
+    std::vector<std::thread> finished_clients;
+
+    void work();
+    void serve(int client);
+    [[nodiscard]] std::string handle(const std::string &request, LineReader &reader);
+    [[nodiscard]] std::shared_ptr<Entry> find(std::int64_t id);
+    [[nodiscard]] Grid spare_grid(int width, int height);
+public:
+    explicit StepServer(const std::string &socket_path, int threads = 0, std::int64_t max_cells = std::int64_t{1} << 28);
+    StepServer(const StepServer &other) = delete;
+    StepServer& operator=(const StepServer &other) = delete;
+    ~StepServer();
+
+    void run();
+    void stop();
+    [[nodiscard]] std::size_t get_world_count();
+};
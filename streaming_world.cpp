@@ -0,0 +1,476 @@
+/**
+ * Implements a class for simulating boards too large to fit in memory.
+ *      - A StreamingWorld is kept in a cell file on disk, which is memory mapped rather than read in.
+ *          - Cell files are composed of:
+ *              - a 4 byte int representing the grid width
+ *              - a 4 byte int representing the grid height
+ *              - followed by (width * height) Cell bytes, ' ' for Cell::DEAD and '#' for Cell::ALIVE,
+ *                in C-style row/column format with no separators.
+ *          - One byte per cell lets any band of rows be used straight from the mapping.
+ *
+ *      - Each step sweeps down the board one band of rows at a time.
+ *          - A band and its two halo rows are copied into a Grid and stepped in place by a World, then written
+ *            to a scratch file next to the cell file, path + ".next".
+ *          - The next band is prefetched with madvise(MADV_WILLNEED) while the current one is stepped, the kernel
+ *            reads it in the background.
+ *          - Rows no later band needs are dropped from the mappings, so the resident memory is a few bands
+ *            however large the board is.
+ *          - Once the sweep is done the two files swap names, the cell file always holds the latest generation.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "streaming_world.h"
+
+namespace {
+    constexpr std::size_t HEADER_SIZE = 8;
+    constexpr std::size_t TARGET_BAND_BYTES = std::size_t{32} << 20;
+}
+
+/**
+ * StreamingWorld::StreamingWorld(path, band_rows = 0)
+ *
+ * Open a cell file as a streaming world. The file is mapped, not read in, and a scratch file of the same size
+ * is created next to it for the next generation.
+ *
+ * @example
+ *
+ *      // Write out a board and stream it 100 generations forward on disk
+ *      StreamingWorld::create("path/to/board.cells", Zoo::load_binary("path/to/file.bgol"));
+ *      StreamingWorld world("path/to/board.cells");
+ *      world.advance(100);
+ *
+ * @param path
+ *      The cell file holding the initial state, which is updated in place as the world steps.
+ *
+ * @param band_rows
+ *      Optional parameter. The number of rows stepped at a time. Defaults to 0, which picks bands of about 32MB.
+ *
+ * @throws
+ *      Throws std::runtime_error if the file cannot be opened or mapped, or is not a valid cell file.
+ */
+StreamingWorld::StreamingWorld(const std::string &path, const int band_rows)
+    : path(path), scratch_path(path + ".next"){
+    if(band_rows < 0){
+        throw std::runtime_error("StreamingWorld::StreamingWorld() : The band height cannot be negative");
+    }
+    current = map_file(path, 0, false);
+
+    std::int32_t header[2];
+    if(current.size < HEADER_SIZE){
+        unmap_file(current);
+        throw std::runtime_error("StreamingWorld::StreamingWorld() : Unexpected end of file");
+    }
+    std::memcpy(header, current.data, HEADER_SIZE);
+    width = header[0];
+    height = header[1];
+    if(width < 0 || height < 0 || current.size - HEADER_SIZE < static_cast<std::size_t>(width) * static_cast<std::size_t>(height)){
+        unmap_file(current);
+        throw std::runtime_error("StreamingWorld::StreamingWorld() : Not a valid cell file");
+    }
+
+    const int auto_rows = static_cast<int>(std::min<std::size_t>(TARGET_BAND_BYTES / std::max(width, 1), height));
+    this->band_rows = std::max(1, (band_rows > 0) ? band_rows : auto_rows);
+
+    try {
+        next = map_file(scratch_path, current.size, true);
+    }
+    catch (...) {
+        unmap_file(current);
+        throw;
+    }
+    std::memcpy(next.data, current.data, HEADER_SIZE); // Only the header, every row is written before it is read
+    band_world.set_in_place(true);
+}
+
+/**
+ * StreamingWorld::~StreamingWorld()
+ *
+ * Unmap both files and remove the scratch file. The cell file keeps the latest generation.
+ */
+StreamingWorld::~StreamingWorld(){
+    unmap_file(current);
+    unmap_file(next);
+    std::remove(scratch_path.c_str());
+}
+
+/**
+ * StreamingWorld::create(path, state)
+ *
+ * Write a grid, or a view of part of one, out as a cell file.
+ *
+ * @example
+ *
+ *      // Save the top left corner of a grid as a cell file
+ *      StreamingWorld::create("path/to/board.cells", grid.view(0, 0, 1024, 1024));
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param state
+ *      The cells to write.
+ *
+ * @throws
+ *      Throws std::runtime_error if the file cannot be opened.
+ */
+void StreamingWorld::create(const std::string &path, const GridView &state){
+    std::ofstream write(path, std::ios::binary | std::ios::out);
+    if(!write){
+        throw std::runtime_error("StreamingWorld::create() : Could not open file, path does not exist:" + path);
+    }
+    const std::int32_t header[2] = {state.get_width(), state.get_height()};
+    write.write((const char *) header, HEADER_SIZE);
+    if(state.get_width() > 0){
+        for(int y = 0; y < state.get_height(); y++){
+            write.write((const char *) &state(0, y), state.get_width());
+        }
+    }
+    write.close();
+}
+
+/**
+ * StreamingWorld::create(path, width, height)
+ *
+ * Write out a cell file of the given size filled with dead cells, one row at a time.
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param width
+ *      The width of the board.
+ *
+ * @param height
+ *      The height of the board.
+ *
+ * @throws
+ *      Throws std::runtime_error if either size is negative or the file cannot be opened.
+ */
+void StreamingWorld::create(const std::string &path, const int width, const int height){
+    if(width < 0 || height < 0){
+        throw std::runtime_error("StreamingWorld::create() : Negative sizes are not valid dimensions");
+    }
+    std::ofstream write(path, std::ios::binary | std::ios::out);
+    if(!write){
+        throw std::runtime_error("StreamingWorld::create() : Could not open file, path does not exist:" + path);
+    }
+    const std::int32_t header[2] = {width, height};
+    write.write((const char *) header, HEADER_SIZE);
+    const std::vector<Cell> dead_row(width, Cell::DEAD);
+    for(int y = 0; y < height; y++){
+        write.write((const char *) dead_row.data(), width);
+    }
+    write.close();
+}
+
+/**
+ * StreamingWorld::map_file(file_path, size, create)
+ *
+ * Private helper that opens a file and maps the whole of it for reading and writing.
+ *
+ * @param file_path
+ *      The file to map.
+ *
+ * @param size
+ *      The size to make the file when creating it, ignored otherwise.
+ *
+ * @param create
+ *      If true the file is created, or emptied, and sized to size. If false it must already exist.
+ *
+ * @return
+ *      The open file and its mapping.
+ *
+ * @throws
+ *      Throws std::runtime_error if the file cannot be opened, sized, or mapped.
+ */
+StreamingWorld::Mapping StreamingWorld::map_file(const std::string &file_path, const std::size_t size, const bool create){
+    Mapping mapping;
+    mapping.file = create ? open(file_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) : open(file_path.c_str(), O_RDWR);
+    if(mapping.file < 0){
+        throw std::runtime_error("StreamingWorld::map_file() : Could not open file, path does not exist:" + file_path);
+    }
+
+    struct stat status{};
+    if(create ? ftruncate(mapping.file, static_cast<off_t>(size)) != 0 : fstat(mapping.file, &status) != 0){
+        close(mapping.file);
+        throw std::runtime_error("StreamingWorld::map_file() : Could not size file:" + file_path);
+    }
+    mapping.size = create ? size : static_cast<std::size_t>(status.st_size);
+
+    if(mapping.size > 0){
+        void *data = mmap(nullptr, mapping.size, PROT_READ | PROT_WRITE, MAP_SHARED, mapping.file, 0);
+        if(data == MAP_FAILED){
+            close(mapping.file);
+            throw std::runtime_error("StreamingWorld::map_file() : Could not map file:" + file_path);
+        }
+        mapping.data = static_cast<char *>(data);
+    }
+    return mapping;
+}
+
+/**
+ * StreamingWorld::unmap_file(mapping)
+ *
+ * Private helper that unmaps and closes a file mapped by StreamingWorld::map_file, leaving the mapping empty.
+ *
+ * @param mapping
+ *      The mapping to release.
+ */
+void StreamingWorld::unmap_file(Mapping &mapping){
+    if(mapping.data != nullptr){
+        munmap(mapping.data, mapping.size);
+    }
+    if(mapping.file >= 0){
+        close(mapping.file);
+    }
+    mapping = Mapping();
+}
+
+/**
+ * StreamingWorld::advise(mapping, begin, end, advice)
+ *
+ * Private helper that passes madvise advice for the bytes [begin, end) of a mapping, widened to whole pages.
+ * Dropping a page that still holds wanted rows is harmless, they are read back from the file when next used.
+ *
+ * @param mapping
+ *      The mapping the bytes are in.
+ *
+ * @param begin
+ *      The offset of the first byte.
+ *
+ * @param end
+ *      The offset one past the last byte.
+ *
+ * @param advice
+ *      The madvise advice, such as MADV_WILLNEED or MADV_DONTNEED.
+ */
+void StreamingWorld::advise(const Mapping &mapping, const std::size_t begin, const std::size_t end, const int advice){
+    if(mapping.data == nullptr || begin >= end){
+        return;
+    }
+    const auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const std::size_t first = begin / page * page;
+    const std::size_t last = std::min(mapping.size, (end + page - 1) / page * page);
+    madvise(mapping.data + first, last - first, advice);
+}
+
+/**
+ * StreamingWorld::row_offset(y)
+ *
+ * Private helper to find where a row starts in a cell file.
+ *
+ * @param y
+ *      The row, which may be height for the offset one past the last row.
+ *
+ * @return
+ *      The offset of the first cell of the row from the start of the file.
+ */
+std::size_t StreamingWorld::row_offset(const int y) const{
+    return HEADER_SIZE + static_cast<std::size_t>(y) * width;
+}
+
+/**
+ * StreamingWorld::copy_row(y, band_y)
+ *
+ * Private helper that copies a row of the current generation into a row of the band being stepped.
+ * Rows outside the board are dead, callers wrap y first when the board is toroidal.
+ *
+ * @param y
+ *      The row of the board, which may be -1 or height for the halo rows.
+ *
+ * @param band_y
+ *      The row of the band to copy it to.
+ */
+void StreamingWorld::copy_row(const int y, const int band_y){
+    Cell *destination = &band(0, band_y);
+    if(y < 0 || y >= height){
+        std::fill(destination, destination + width, Cell::DEAD);
+    } else {
+        std::memcpy(destination, current.data + row_offset(y), width);
+    }
+}
+
+/**
+ * StreamingWorld::get_width()
+ *
+ * @return
+ *      The width of the board.
+ */
+int StreamingWorld::get_width() const{
+    return width;
+}
+
+/**
+ * StreamingWorld::get_height()
+ *
+ * @return
+ *      The height of the board.
+ */
+int StreamingWorld::get_height() const{
+    return height;
+}
+
+/**
+ * StreamingWorld::get_band_rows()
+ *
+ * @return
+ *      The number of rows stepped at a time.
+ */
+int StreamingWorld::get_band_rows() const{
+    return band_rows;
+}
+
+/**
+ * StreamingWorld::get_alive_cells()
+ *
+ * Counts how many cells on the board are alive, sweeping the file a band at a time.
+ *
+ * @return
+ *      The number of alive cells.
+ */
+std::int64_t StreamingWorld::get_alive_cells() const{
+    std::int64_t no_alive = 0;
+    for(int y0 = 0; y0 < height; y0 += band_rows){
+        const int y1 = std::min(height - y0, band_rows) + y0;
+        const char *first = current.data + row_offset(y0);
+        const char *last = current.data + row_offset(y1);
+        no_alive += std::count(first, last, static_cast<char>(Cell::ALIVE));
+        advise(current, row_offset(y0), row_offset(y1), MADV_DONTNEED);
+    }
+    return no_alive;
+}
+
+/**
+ * StreamingWorld::load_rows(y0, y1)
+ *
+ * Read some rows of the current generation into memory.
+ *
+ * @example
+ *
+ *      // Print the first 16 rows of a board
+ *      std::cout << world.load_rows(0, 16) << std::endl;
+ *
+ * @param y0
+ *      The first row to read.
+ *
+ * @param y1
+ *      One past the last row to read.
+ *
+ * @return
+ *      A grid holding the rows [y0, y1) across the whole width of the board.
+ *
+ * @throws
+ *      Throws std::runtime_error if the rows are not on the board.
+ */
+Grid StreamingWorld::load_rows(const int y0, const int y1) const{
+    if(y0 < 0 || y1 > height || y1 < y0){
+        throw std::runtime_error("StreamingWorld::load_rows() : Not a valid row range");
+    }
+    Grid rows(width, y1 - y0);
+    if(width > 0){
+        for(int y = y0; y < y1; y++){
+            std::memcpy(&rows(0, y - y0), current.data + row_offset(y), width);
+        }
+    }
+    return rows;
+}
+
+/**
+ * StreamingWorld::step(toroidal)
+ *
+ * Take one step in Conway's Game of Life, sweeping down the board one band at a time.
+ * Each band is copied into memory with the row above and below it, stepped in place, and written to the scratch
+ * file, which then swaps names with the cell file.
+ *
+ * @example
+ *
+ *      // Step a board on disk forward once on a torus
+ *      StreamingWorld world("path/to/board.cells");
+ *      world.step(true);
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom. Defaults to false.
+ *
+ * @throws
+ *      Throws std::runtime_error if the files cannot be swapped over.
+ */
+void StreamingWorld::step(const bool toroidal){
+    if(width == 0 || height == 0){
+        return;
+    }
+    advise(current, row_offset(0), row_offset(std::min(band_rows + 1, height)), MADV_WILLNEED);
+
+    for(int y0 = 0; y0 < height; y0 += band_rows){
+        const int y1 = std::min(height - y0, band_rows) + y0;
+
+        // Ask for the next band while this one is worked on
+        if(y1 < height){
+            advise(current, row_offset(y1), row_offset(std::min(height - y1, band_rows + 1) + y1), MADV_WILLNEED);
+        }
+
+        // The band with a halo row either side, rows off the top and bottom wrap round on a torus
+        band.resize(width, (y1 - y0) + 2);
+        copy_row(toroidal ? (y0 - 1 + height) % height : y0 - 1, 0);
+        for(int y = y0; y < y1; y++){
+            copy_row(y, (y - y0) + 1);
+        }
+        copy_row(toroidal ? y1 % height : y1, (y1 - y0) + 1);
+
+        // The halo rows stand in for the top and bottom wrap, so only the sides need to wrap here
+        band_world.replace_state(std::move(band));
+        if(toroidal){
+            band_world.step<CylinderBoundary>();
+        } else {
+            band_world.step<DeadBoundary>();
+        }
+        band = band_world.take_state();
+
+        for(int y = y0; y < y1; y++){
+            std::memcpy(next.data + row_offset(y), &band(0, (y - y0) + 1), width);
+        }
+
+        // Let go of everything but the last row, the next band's halo
+        advise(current, row_offset(std::max(0, y0 - 1)), row_offset(y1 - 1), MADV_DONTNEED);
+        advise(next, row_offset(y0), row_offset(y1), MADV_DONTNEED);
+    }
+
+    // Swap the file names so the cell file holds the new generation
+    const std::string held_path = path + ".swap";
+    if(std::rename(path.c_str(), held_path.c_str()) != 0
+       || std::rename(scratch_path.c_str(), path.c_str()) != 0
+       || std::rename(held_path.c_str(), scratch_path.c_str()) != 0){
+        throw std::runtime_error("StreamingWorld::step() : Could not swap the cell file and the scratch file");
+    }
+    std::swap(current, next);
+}
+
+/**
+ * StreamingWorld::advance(steps, toroidal)
+ *
+ * Advance multiple steps in the Game of Life.
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom. Defaults to false.
+ */
+void StreamingWorld::advance(const int steps, const bool toroidal){
+    for(int i = 0; i < steps; i++){
+        step(toroidal);
+    }
+}
@@ -0,0 +1,65 @@
+/**
+ * Declares a class for simulating boards too large to fit in memory, streamed band by band from memory mapped files.
+ * Rich documentation for the api and behaviour the StreamingWorld class can be found in streaming_world.cpp.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "grid.h"
+#include "world.h"
+
+/**
+ * Declare the structure of the StreamingWorld class, an out of core world kept in a cell file on disk.
+ *
+ * The current and next generations live in two memory mapped files. Each step sweeps down the board one band
+ * of rows at a time, so only a band, its halo rows, and the band being prefetched are resident at once.
+ */
+class StreamingWorld {
+private:
+    struct Mapping {
+        int file = -1;
+        char *data = nullptr;
+        std::size_t size = 0;
+    };
+
+    std::string path;
+    std::string scratch_path;
+    int width = 0;
+    int height = 0;
+    int band_rows;
+    Mapping current; // The file holding the current generation, always found at path
+    Mapping next; // The scratch file the next generation is written into
+    World band_world; // Steps one band plus its halo rows in place
+    Grid band; // The band being stepped, reused between bands
+
+    static Mapping map_file(const std::string &file_path, std::size_t size, bool create);
+    static void unmap_file(Mapping &mapping);
+    static void advise(const Mapping &mapping, std::size_t begin, std::size_t end, int advice);
+    [[nodiscard]] std::size_t row_offset(int y) const;
+    void copy_row(int y, int band_y);
+public:
+    // Constructors & destructors
+    explicit StreamingWorld(const std::string &path, int band_rows = 0);
+    StreamingWorld(const StreamingWorld &other) = delete;
+    StreamingWorld& operator=(const StreamingWorld &other) = delete;
+    ~StreamingWorld();
+
+    // Cell files
+    static void create(const std::string &path, const GridView &state);
+    static void create(const std::string &path, int width, int height);
+
+    // Getters
+    [[nodiscard]] int get_width() const;
+    [[nodiscard]] int get_height() const;
+    [[nodiscard]] int get_band_rows() const;
+    [[nodiscard]] std::int64_t get_alive_cells() const;
+    [[nodiscard]] Grid load_rows(int y0, int y1) const;
+
+    // step functions
+    void step(bool toroidal = false);
+    void advance(int steps, bool toroidal = false);
+};
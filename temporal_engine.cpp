@@ -0,0 +1,230 @@
+/**
+ * Implements the temporal blocking step engine.
+ *      - The board is stored as one byte per cell, 1 for alive and 0 for dead.
+ *      - A pass over the board advances it up to depth generations at once. For each tile x tile square the tile
+ *        plus a halo of depth cells on every side is copied into a small buffer that stays in cache, stepped there
+ *        depth times, and only the tile itself is written back.
+ *      - Each generation the cells at the edge of the buffer are missing neighbours, so the correct region
+ *        shrinks by one cell per side. After depth generations exactly the tile is still correct.
+ *
+ * On boards much larger than the cache a plain step streams the whole board through memory every generation,
+ * this streams it once every depth generations instead, at the cost of recomputing the overlapping halos.
+ *
+ * @author 951536
+ * @date March, 2020
+ */
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include "engine.h"
+
+/**
+ * TemporalEngine::TemporalEngine(tile, depth)
+ *
+ * Construct an empty temporal engine.
+ *
+ * @example
+ *
+ *      // Advance 256x256 tiles 16 generations per pass
+ *      TemporalEngine engine(256, 16);
+ *
+ * @param tile
+ *      Optional parameter. The edge length of the square tiles written back each pass. Defaults to 128.
+ *
+ * @param depth
+ *      Optional parameter. The most generations to advance each tile per pass, also the halo width. Defaults to 8.
+ *
+ * @throws
+ *      std::runtime_error if the tile or depth is less than 1.
+ */
+TemporalEngine::TemporalEngine(const int tile, const int depth) : tile(tile), depth(depth){
+    if(tile < 1 || depth < 1){
+        throw std::runtime_error("TemporalEngine::TemporalEngine() : The tile size and depth must be at least 1");
+    }
+}
+
+/**
+ * TemporalEngine::get_name()
+ *
+ * @return
+ *      The registered name of the engine, "temporal".
+ */
+std::string TemporalEngine::get_name() const{
+    return "temporal";
+}
+
+/**
+ * TemporalEngine::load_state(state)
+ *
+ * Copy a grid in as one byte per cell. The grid's own storage is released afterwards.
+ *
+ * @param state
+ *      The grid to load, left empty.
+ */
+void TemporalEngine::load_state(Grid &&state){
+    width = state.get_width();
+    height = state.get_height();
+
+    const GridView view = state;
+    cur_cells.assign(static_cast<std::size_t>(width) * height, 0);
+    next_cells.assign(cur_cells.size(), 0);
+    for(int y = 0; y < height; y++){
+        for(int x = 0; x < width; x++){
+            cur_cells[static_cast<std::size_t>(y) * width + x] = (view(x, y) == Cell::ALIVE) ? 1 : 0;
+        }
+    }
+
+    state = Grid();
+}
+
+/**
+ * TemporalEngine::advance_tile(x0, y0, generations, toroidal)
+ *
+ * Private helper that advances the tile with its top left corner at x0, y0 by a number of generations,
+ * reading the current board and writing the tile into the next board.
+ *
+ * The buffer covers the tile plus a halo of generations cells. With dead edges any part of the buffer
+ * outside the board is zeroed and never written, so it reads as dead every generation. When toroidal
+ * the buffer is filled by wrapping coordinates, so it is simply a window onto the repeating plane.
+ *
+ * @param x0
+ *      The left edge of the tile.
+ *
+ * @param y0
+ *      The top edge of the tile.
+ *
+ * @param generations
+ *      The number of generations to advance, at most depth.
+ *
+ * @param toroidal
+ *      If true then the board is treated as a torus.
+ */
+void TemporalEngine::advance_tile(const int x0, const int y0, const int generations, const bool toroidal){
+    const int tile_width = std::min(tile, width - x0);
+    const int tile_height = std::min(tile, height - y0);
+    const int buffer_width = tile_width + 2 * generations;
+    const int buffer_height = tile_height + 2 * generations;
+    const std::size_t buffer_size = static_cast<std::size_t>(buffer_width) * buffer_height;
+
+    for(std::vector<std::uint8_t> &buffer : tile_cells){
+        buffer.assign(buffer_size, 0);
+    }
+
+    // The buffer's top left cell sits at board coordinate (left, top)
+    const int left = x0 - generations;
+    const int top = y0 - generations;
+
+    // Copy in the tile and its halo, and note the part of the buffer that lies on the board
+    int inside_x0 = 0, inside_x1 = buffer_width, inside_y0 = 0, inside_y1 = buffer_height;
+    if(!toroidal){
+        inside_x0 = std::max(0, -left);
+        inside_y0 = std::max(0, -top);
+        inside_x1 = std::min(buffer_width, width - left);
+        inside_y1 = std::min(buffer_height, height - top);
+    }
+    for(int y = inside_y0; y < inside_y1; y++){
+        const int board_y = ((top + y) % height + height) % height;
+        const std::uint8_t *row = cur_cells.data() + static_cast<std::size_t>(board_y) * width;
+        std::uint8_t *out = tile_cells[0].data() + static_cast<std::size_t>(y) * buffer_width;
+
+        // Copy the row in runs that do not cross the edge of the board
+        for(int x = inside_x0; x < inside_x1;){
+            const int board_x = ((left + x) % width + width) % width;
+            const int run = std::min(inside_x1 - x, width - board_x);
+            std::copy(row + board_x, row + board_x + run, out + x);
+            x += run;
+        }
+    }
+
+    // Each generation is only correct one cell further in from the edge of the buffer than the last
+    for(int generation = 1; generation <= generations; generation++){
+        const std::uint8_t *from = tile_cells[(generation - 1) % 2].data();
+        std::uint8_t *to = tile_cells[generation % 2].data();
+
+        const int y_begin = std::max(generation, inside_y0);
+        const int y_end = std::min(buffer_height - generation, inside_y1);
+        const int x_begin = std::max(generation, inside_x0);
+        const int x_end = std::min(buffer_width - generation, inside_x1);
+
+        for(int y = y_begin; y < y_end; y++){
+            const std::uint8_t *above = from + static_cast<std::size_t>(y - 1) * buffer_width;
+            const std::uint8_t *centre = above + buffer_width;
+            const std::uint8_t *below = centre + buffer_width;
+            std::uint8_t *next = to + static_cast<std::size_t>(y) * buffer_width;
+
+            for(int x = x_begin; x < x_end; x++){
+                const int alive = above[x - 1] + above[x] + above[x + 1]
+                                + centre[x - 1]             + centre[x + 1]
+                                + below[x - 1] + below[x] + below[x + 1];
+                // 3 neighbours, or 2 neighbours and alive, are the only totals that OR with the cell to make 3
+                next[x] = ((alive | centre[x]) == 3) ? 1 : 0;
+            }
+        }
+    }
+
+    // Only the tile itself is known to be correct after all the generations
+    const std::uint8_t *result = tile_cells[generations % 2].data();
+    for(int y = 0; y < tile_height; y++){
+        const std::uint8_t *row = result + static_cast<std::size_t>(y + generations) * buffer_width + generations;
+        std::copy(row, row + tile_width, next_cells.begin() + static_cast<std::size_t>(y0 + y) * width + x0);
+    }
+}
+
+/**
+ * TemporalEngine::step(steps, toroidal)
+ *
+ * Advance the board in passes of up to depth generations, every tile advancing the full pass before the boards swap.
+ *
+ * @param steps
+ *      The number of steps to advance the board forward.
+ *
+ * @param toroidal
+ *      If true then the board is treated as a torus.
+ */
+void TemporalEngine::step(int steps, const bool toroidal){
+    if(width == 0 || height == 0){
+        return;
+    }
+    while(steps > 0){
+        const int generations = std::min(steps, depth);
+        for(int y0 = 0; y0 < height; y0 += tile){
+            for(int x0 = 0; x0 < width; x0 += tile){
+                advance_tile(x0, y0, generations, toroidal);
+            }
+        }
+        std::swap(cur_cells, next_cells);
+        steps -= generations;
+    }
+}
+
+/**
+ * TemporalEngine::export_state()
+ *
+ * @return
+ *      A grid holding the current generation.
+ */
+Grid TemporalEngine::export_state() const{
+    Grid state(width, height);
+    for(int y = 0; y < height; y++){
+        for(int x = 0; x < width; x++){
+            if(cur_cells[static_cast<std::size_t>(y) * width + x]){
+                state(x, y) = Cell::ALIVE;
+            }
+        }
+    }
+    return state;
+}
+
+int TemporalEngine::get_width() const{
+    return width;
+}
+
+int TemporalEngine::get_height() const{
+    return height;
+}
+
+std::int64_t TemporalEngine::get_alive_cells() const{
+    return std::accumulate(cur_cells.begin(), cur_cells.end(), std::int64_t{0});
+}
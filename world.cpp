@@ -14,16 +14,55 @@
  *      - Worlds have a private helper function used to count the number of alive cells in a 3x3 neighbours
  *        around a given cell.
  *
+ *      - Worlds keep the bounding box of their alive cells. Steps bounded by dead edges only visit the box grown by
+ *        one cell, so a small pattern on a large board costs about as much as the pattern.
+ *
  *      - Updating the world state can conditionally be performed using a toroidal topology.
  *          - Moving off the left edge you appear on the right edge and vice versa.
  *          - Moving off the top edge you appear on the bottom edge and vice versa.
  *
+ *      - Worlds can step in an event driven mode that only evaluates the cells around the last generation's changes,
+ *        reporting the births and deaths of each step.
+ *
+ *      - Worlds can step in place, writing each generation back into the current state with a few saved rows
+ *        instead of a full next state grid.
+ *
+ *      - Worlds can take copy on write snapshots of their state and restore them, see Snapshot.
+ *          - Each snapshot shares the tiles that are unchanged since the world's last snapshot.
+ *
+ *      - Worlds count the generations they step through, and can record them within a memory budget as keyframes
+ *        and per generation deltas, see History. World::seek goes back to any recorded generation.
+ *
+ *      - Worlds can defer their steps in a lazy mode, running every pending step as one run once the state is read.
+ *
+ *      - Steps can be split into bands of rows across threads, and World::calibrate can time candidate
+ *        configurations to pick the fastest for the board and machine.
+ *          - The threads are kept in a BandPool between steps, so each generation only pays to wake them.
+ *          - In numa mode each thread owns one band, pinned to its own CPUs, and the band's pages are first touched
+ *            by a thread pinned the same way so they sit on the memory node that steps them.
+ *
+ *      - The edges are handled by boundary policies (DeadBoundary, ToroidalBoundary, CylinderBoundary) given as
+ *        template arguments, so each topology compiles to its own update loop with no per cell topology checks.
+ *
  * @author 951536
  * @date March, 2020
  */
 
 // Include the minimal number of headers needed to support your implementation.
 // #include ...
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
 #include "world.h"
 #include "grid.h"
 
@@ -101,9 +140,140 @@ World::World(const int width, const int height){
  * @param initial_state
  *      The state of the constructed world.
  */
-World::World(const Grid &initial_state){
-    cur_world = initial_state;
-    next_world = cur_world;
+World::World(const Grid &initial_state)
+    : cur_world(initial_state), next_world(initial_state.get_width(), initial_state.get_height()){}
+
+/**
+ * World::World(initial_state)
+ *
+ * Construct a world by taking ownership of an existing grid, without copying its cells.
+ * Only the next state buffer is allocated, so peak memory is the grid plus one scratch buffer.
+ *
+ * @example
+ *
+ *      // Load a grid straight into a world
+ *      World world(Zoo::load_ascii("path/to/file.gol"));
+ *
+ *      // Hand over a grid that is no longer needed
+ *      Grid grid(16, 9);
+ *      World other(std::move(grid));
+ *
+ * @param initial_state
+ *      The state of the constructed world, left empty after the move.
+ */
+World::World(Grid &&initial_state)
+    : cur_world(std::move(initial_state)), next_world(cur_world.get_width(), cur_world.get_height()){}
+
+/**
+ * World::World(other)
+ *
+ * Copy constructor. Lazy steps still pending in the other world are carried out on the copy, so a copy never
+ * holds pending steps of its own and can be read as a const object. Scratch buffers are not copied.
+ *
+ * @example
+ *
+ *      // Branch a lazy world and read the branch without stepping the original
+ *      world.set_lazy(true);
+ *      world.advance(10);
+ *      const World branch = world;
+ *      std::cout << branch.get_alive_cells() << std::endl;
+ *
+ * @param other
+ *      The world to copy.
+ */
+World::World(const World &other)
+    : cur_world(other.cur_world), next_world(other.next_world), config(other.config), in_place(other.in_place),
+      event_driven(other.event_driven), changes_valid(other.changes_valid), changes_boundary(other.changes_boundary),
+      changes(other.changes), births(other.births), deaths(other.deaths), last_snapshot(other.last_snapshot),
+      snapshot_valid(other.snapshot_valid), generation(other.generation), history(other.history),
+      history_valid(other.history_valid), live_box(other.live_box), live_box_valid(other.live_box_valid),
+      next_box(other.next_box), next_box_valid(other.next_box_valid), lazy(other.lazy),
+      pending_steps(other.pending_steps), pending_advance(other.pending_advance){
+    if(pending_steps > 0){
+        flush();
+    }
+}
+
+/**
+ * World::operator=(other)
+ *
+ * Copy assignment, see World::World(other). Pending lazy steps are carried out on the copy.
+ *
+ * @param other
+ *      The world to copy.
+ *
+ * @return
+ *      A reference to this world.
+ */
+World& World::operator=(const World &other){
+    if(this != &other){
+        *this = World(other);
+    }
+    return *this;
+}
+
+/**
+ * World::World(other)
+ *
+ * Move constructor, see World::operator=(World&&). Lazy steps still pending in the other world are carried out
+ * on this one, so a world made const by moving into it never holds pending steps.
+ *
+ * @param other
+ *      The world to take the state of, left as an empty 0x0 world.
+ */
+World::World(World &&other) : World(){
+    *this = std::move(other);
+}
+
+/**
+ * World::operator=(other)
+ *
+ * Move assignment, takes the state, history, configuration and threads of another world without copying them.
+ * Lazy steps still pending in the other world are carried out once they have been taken. Scratch buffers are
+ * not taken.
+ *
+ * @param other
+ *      The world to take the state of, left as an empty 0x0 world.
+ *
+ * @return
+ *      A reference to this world.
+ */
+World& World::operator=(World &&other){
+    if(this != &other){
+        cur_world = std::move(other.cur_world);
+        next_world = std::move(other.next_world);
+        config = other.config;
+        pool = std::move(other.pool);
+        in_place = other.in_place;
+        event_driven = other.event_driven;
+        changes_valid = other.changes_valid;
+        changes_boundary = other.changes_boundary;
+        changes = std::move(other.changes);
+        births = std::move(other.births);
+        deaths = std::move(other.deaths);
+        last_snapshot = std::move(other.last_snapshot);
+        snapshot_valid = other.snapshot_valid;
+        generation = other.generation;
+        history = std::move(other.history);
+        history_valid = other.history_valid;
+        live_box = other.live_box;
+        live_box_valid = other.live_box_valid;
+        next_box = other.next_box;
+        next_box_valid = other.next_box_valid;
+        lazy = other.lazy;
+        pending_steps = other.pending_steps;
+        pending_advance = other.pending_advance;
+        other.pending_steps = 0;
+        other.changes_valid = false;
+        other.snapshot_valid = false;
+        other.history_valid = false;
+        other.live_box_valid = false;
+        other.next_box_valid = false;
+        if(pending_steps > 0){
+            flush();
+        }
+    }
+    return *this;
 }
 
 /**
@@ -185,8 +355,8 @@ int World::get_height() const {
  * @return
  *      The number of total cells.
  */
-int World::get_total_cells() const {
-    const int total_cells = cur_world.get_total_cells();
+std::int64_t World::get_total_cells() const {
+    const std::int64_t total_cells = cur_world.get_total_cells();
     return total_cells;
 }
 
@@ -213,8 +383,9 @@ int World::get_total_cells() const {
  * @return
  *      The number of alive cells.
  */
-int World::get_alive_cells() const {
-    const int alive_cells = cur_world.get_alive_cells();
+std::int64_t World::get_alive_cells() const {
+    settle();
+    const std::int64_t alive_cells = cur_world.get_alive_cells();
     return alive_cells;
 }
 
@@ -241,8 +412,9 @@ int World::get_alive_cells() const {
  * @return
  *      The number of dead cells.
  */
-int World::get_dead_cells() const {
-    const int dead_cells = cur_world.get_dead_cells();
+std::int64_t World::get_dead_cells() const {
+    settle();
+    const std::int64_t dead_cells = cur_world.get_dead_cells();
     return dead_cells;
 }
 
@@ -271,9 +443,35 @@ int World::get_dead_cells() const {
  *      A reference to the current state.
  */
 const Grid& World::get_state() const {
+    settle();
     return cur_world;
 }
 
+/**
+ * World::occupied()
+ *
+ * Gets a view of the smallest rectangle holding every alive cell, for printing or saving only the occupied
+ * region of a large world. The bounds are kept up to date by bounded steps, so this is usually free.
+ *
+ * @example
+ *
+ *      // Print and save only the part of a large board with anything on it
+ *      std::cout << world.occupied() << std::endl;
+ *      Zoo::save_ascii("path/to/file.gol", world.occupied());
+ *
+ * @return
+ *      A view of the occupied region, 0x0 if there are no alive cells. Like World::get_state it is only valid
+ *      until the world next changes.
+ */
+GridView World::occupied() const{
+    settle();
+    if(!live_box_valid){
+        live_box = find_box(cur_world, {0, 0, get_width(), get_height()});
+        live_box_valid = true;
+    }
+    return cur_world.view(live_box.x0, live_box.y0, live_box.x1, live_box.y1);
+}
+
 /**
  * World::resize(square_size)
  *
@@ -320,158 +518,1586 @@ void World::resize(const int square_size){
  *      The new height for the grid.
  */
 void World::resize(const int width, const int height){
+    settle();
     cur_world.resize(width, height);
-    next_world.resize(width,height);
+    if(!in_place){
+        next_world.resize(width,height);
+    }
+    if(config.numa){
+        place_bands();
+    }
+    changes_valid = false;
+    snapshot_valid = false;
+    history.clear();
+    history_valid = false;
+    live_box_valid = false;
+    next_box_valid = false;
 }
 
 /**
- * World::count_neighbours(x, y, toroidal)
+ * World::take_state()
  *
- * Private helper function to count the number of alive neighbours of a cell.
- * The function should not be visible from outside the World class.
+ * Move the current state grid out of the world without copying it, for example to hand the final
+ * state to a saver. The world is left as an empty 0x0 world and the next state buffer is released.
  *
- * Neighbours are considered within the 3x3 square centred around the cell at x,y in the current state grid.
- * Ignore the centre coordinate, a cell is not its own neighbour.
- * Attempt to keep the logic as simple, expressive, and readable as possible.
+ * @example
  *
- * If toroidal = false then skip any neighbours that would be outside of the grid,
- * this assumes the grid is Cell::DEAD outside its bounds.
+ *      // Make a world and run it
+ *      World world(Zoo::glider());
+ *      world.advance(4);
  *
- * If toroidal = true then correctly wrap out of bounds coordinates to the opposite side of the grid.
+ *      // Keep the final state and let the world go
+ *      Grid final_state = world.take_state();
  *
- * This function is in World and not Grid because the 3x3 sized neighbourhood is specific to Conway's Game of Life,
- * while Grid is more generic to any 2D grid based cellular automaton.
+ * @return
+ *      The current state grid.
+ */
+Grid World::take_state(){
+    settle();
+    Grid state = std::move(cur_world);
+    cur_world = Grid();
+    next_world = Grid();
+    changes_valid = false;
+    snapshot_valid = false;
+    history.clear();
+    history_valid = false;
+    live_box_valid = false;
+    next_box_valid = false;
+    return state;
+}
+
+/**
+ * World::replace_state(state)
  *
- * @param x
- *      The x coordinate of the centre of the neighbourhood.
+ * Replace the current state of the world by taking ownership of a grid without copying it.
+ * The world takes on the size of the new grid. The next state buffer is kept as it is when the size is
+ * unchanged, its values do not need to be preserved.
  *
- * @param y
- *      The y coordinate of the centre of the neighbourhood.
+ * @example
  *
- * @param toroidal
- *      If true then the step will consider the grid as a torus, where the left edge
- *      wraps to the right edge and the top to the bottom.
+ *      // Make a world
+ *      World world(4, 4);
+ *
+ *      // Swap in a freshly loaded state
+ *      world.replace_state(Zoo::load_ascii("path/to/file.gol"));
+ *
+ * @param state
+ *      The new current state, left empty after the move.
+ */
+void World::replace_state(Grid &&state){
+    drop_pending();
+    cur_world = std::move(state);
+    // The scratch buffer's contents are never read, so it is only reallocated when the size changes
+    if(!in_place && (next_world.get_width() != cur_world.get_width()
+                     || next_world.get_height() != cur_world.get_height())){
+        next_world = Grid(cur_world.get_width(), cur_world.get_height());
+    }
+    if(config.numa){
+        place_bands();
+    }
+    changes_valid = false;
+    snapshot_valid = false;
+    history.clear(); // The recorded generations led to a state the world no longer holds
+    history_valid = false;
+    live_box_valid = false;
+    next_box_valid = false;
+}
+
+/**
+ * World::snapshot()
+ *
+ * Take a copy on write snapshot of the current state. Tiles that are unchanged since the world's last snapshot,
+ * taken or restored, are shared with it rather than copied. Asking again before the world changes returns the
+ * same snapshot without reading the grid.
+ *
+ * @example
+ *
+ *      // Try a perturbation and roll it back
+ *      World world(Zoo::load_ascii("path/to/file.gol"));
+ *      const Snapshot before = world.snapshot();
+ *      Grid state = world.take_state();
+ *      state.set(10, 10, Cell::ALIVE);
+ *      world.replace_state(std::move(state));
+ *      world.advance(100);
+ *      world.restore(before);
  *
  * @return
- *      Returns the number of alive neighbours.
+ *      The snapshot, cheap to copy and keep.
  */
-int World::count_neighbours(const int x, const int y, const bool toroidal) const{
-    const int width = get_width(); // Get width to save computation
-    const int height = get_height(); // Get height to save computation
+Snapshot World::snapshot(){
+    settle();
+    if(!snapshot_valid){
+        last_snapshot = Snapshot(cur_world, last_snapshot);
+        snapshot_valid = true;
+    }
+    return last_snapshot;
+}
 
-    int alive = 0; // Count number of alive cells
+/**
+ * World::restore(snapshot)
+ *
+ * Set the current state from a snapshot, taking on its size. If the world still holds the snapshot it last took
+ * or restored, only the tiles that differ between the two are written.
+ *
+ * @example
+ *
+ *      // Fork a second world from a snapshot of the first
+ *      World branch;
+ *      branch.restore(world.snapshot());
+ *
+ * @param snapshot
+ *      The snapshot to restore.
+ */
+void World::restore(const Snapshot &snapshot){
+    drop_pending();
+    if(get_width() != snapshot.get_width() || get_height() != snapshot.get_height()){
+        resize(snapshot.get_width(), snapshot.get_height());
+    }
+    if(snapshot_valid){
+        snapshot.write_to(cur_world, last_snapshot);
+    } else {
+        snapshot.write_to(cur_world);
+    }
+    last_snapshot = snapshot;
+    snapshot_valid = true;
+    changes_valid = false;
+    history.clear();
+    history_valid = false;
+    live_box_valid = false;
+}
 
-    // See if the centre point is alive.
-    const bool pos_centre = (cur_world.get(x, y) == Cell::ALIVE);
+/**
+ * World::set_history(budget_bytes, keyframe_interval = 64)
+ *
+ * Record the generations the world steps through so World::seek can return to them, see History.
+ * Every keyframe_interval generations the whole state is kept as a snapshot, and the generations in between are
+ * kept as the cells that flipped. The oldest generations are dropped to stay within the memory budget.
+ * Recording starts from the current state on the next step. Steps are never pipelined while recording.
+ *
+ * @example
+ *
+ *      // Keep up to 64MB of history and jump back to an earlier generation
+ *      World world(Zoo::load_ascii("path/to/file.gol"));
+ *      world.set_history(64 << 20);
+ *      world.advance(50000);
+ *      world.seek(48213);
+ *
+ * @param budget_bytes
+ *      The memory the history may use, 0 turns recording off and drops the history.
+ *
+ * @param keyframe_interval
+ *      Optional parameter. The number of generations between keyframes. Defaults to 64.
+ *
+ * @throws
+ *      Throws std::runtime_error if the keyframe interval is less than 1.
+ */
+void World::set_history(const std::size_t budget_bytes, const int keyframe_interval){
+    history.configure(budget_bytes, keyframe_interval);
+    history_valid = false;
+}
 
-    if(!toroidal){
-        // Normal game
-        for(int y_pos=y-1; y_pos<=y+1; y_pos++){
-            for(int x_pos=x-1; x_pos<=x+1; x_pos++){
-                try{ // We expect this to happen if it tries to go out of bounds.
-                    if(cur_world.get(x_pos,y_pos) == Cell::ALIVE){
-                        alive++;
-                    }
-                } catch (std::runtime_error &ex){
-                    continue;
-                }
-            }
-        }
+/**
+ * World::get_generation()
+ *
+ * @return
+ *      The number of steps the world has taken, or the generation it was last seeked to plus the steps since.
+ *      Pending lazy steps are counted.
+ */
+std::int64_t World::get_generation() const{
+    return generation + pending_steps;
+}
 
-    } else {
-        // T game (the world wraps around)
-        for(int y_pos=y-1; y_pos<=y+1; y_pos++){
-            int use_y;
-            use_y = y_pos;
-
-            if(use_y >= height){
-                use_y = 0;
-            } else if (use_y < 0) {
-                use_y = height-1;
-            }
-            
-            for(int x_pos=x-1; x_pos<=x+1; x_pos++){
-                int use_x;
-                use_x = x_pos;
-
-                if(use_x >= width){
-                    use_x = 0;
-                } else if (use_x < 0) {
-                    use_x = width-1;
-                }
+/**
+ * World::get_history_range()
+ *
+ * @return
+ *      The oldest and newest generations World::seek can go to, both -1 if nothing is recorded.
+ */
+std::pair<std::int64_t, std::int64_t> World::get_history_range() const{
+    return history.get_range();
+}
 
-                if(cur_world.get(use_x,use_y) == Cell::ALIVE){
-                    alive++;
-                }
-            }
-        }
+/**
+ * World::seek(target)
+ *
+ * Set the current state to a recorded generation, rebuilt from the nearest keyframe before it and the deltas
+ * after that. Stepping after seeking back replaces the recorded generations after the target. Replacing, resizing
+ * or restoring the state drops the history, as it no longer leads to the world's state.
+ *
+ * @example
+ *
+ *      // Step back one generation at a time
+ *      for(std::int64_t g = world.get_generation() - 1; g >= world.get_history_range().first; g--){
+ *          world.seek(g);
+ *          std::cout << world.get_state() << std::endl;
+ *      }
+ *
+ * @param target
+ *      The generation to go to, within World::get_history_range.
+ *
+ * @throws
+ *      Throws std::runtime_error if the generation is not recorded.
+ */
+void World::seek(const std::int64_t target){
+    settle();
+    history.rebuild(target, cur_world);
+    generation = target;
+    history_valid = true;
+    snapshot_valid = false;
+    changes_valid = false;
+    live_box_valid = false;
+}
+
+/**
+ * World::prepare_history()
+ *
+ * Private helper run before a step while recording, so the history ends at the current generation.
+ * A history that does not describe the current state starts again from it.
+ */
+void World::prepare_history(){
+    if(!history_valid){
+        history.start(cur_world, generation);
+        history_valid = true;
+    } else if(history.get_range().second != generation){
+        history.truncate(cur_world, generation);
     }
+}
 
-    // As this method counts the centre cell its easier to just remove it at the end if it is alive.
-    if(pos_centre && alive > 0){
-        alive--;
+/**
+ * World::set_lazy(enabled)
+ *
+ * In lazy mode World::step and World::advance only note the steps down. They are carried out together, as one
+ * call to World::advance, the next time the state is looked at through World::get_state, the population
+ * counts, the births and deaths, or anything else that needs the cells. Back to back advances then cost one run,
+ * which World::advance_wavefront can pipeline as a whole. Replacing or restoring the state drops the pending
+ * steps without running them. Turning lazy mode off runs any pending steps. The first const read after deferring
+ * runs the steps, so a lazy world is not safe to read from several threads at once until it has been read once.
+ *
+ * @example
+ *
+ *      // Queue up work from several places and only pay for it once the state is read
+ *      World world(Zoo::load_ascii("path/to/file.gol"));
+ *      world.set_config({8, 0, true});
+ *      world.set_lazy(true);
+ *      world.advance(10);
+ *      world.advance(90);
+ *      std::cout << world.get_alive_cells() << std::endl; // Runs all 100 generations as one pipelined run
+ *
+ * @param enabled
+ *      If true then steps are deferred until the state is looked at.
+ */
+void World::set_lazy(const bool enabled){
+    if(!enabled){
+        settle();
     }
-    return alive;
+    lazy = enabled;
+}
 
+/**
+ * World::is_lazy()
+ *
+ * @return
+ *      True if steps are deferred until the state is looked at.
+ */
+bool World::is_lazy() const{
+    return lazy;
 }
 
+/**
+ * World::get_pending_steps()
+ *
+ * @return
+ *      The number of lazy steps noted down but not yet carried out.
+ */
+int World::get_pending_steps() const{
+    return pending_steps;
+}
 
 /**
- * World::step(toroidal)
+ * World::settle()
  *
- * Take one step in Conway's Game of Life.
+ * Private helper that carries out any pending lazy steps before the state is looked at.
  *
- * Reads from the current state grid and writes to the next state grid. Then swaps the grids.
- * Should be implemented by invoking World::count_neighbours(x, y, toroidal).
- * Swapping the grids should be done in O(1) constant time, and should not invoke a copy.
- * Try and boil the logic down to the fewest and most simple conditional statements.
+ * The getters that look at the state are const, but what they return must include the pending steps. Steps can
+ * only become pending through non const calls on a world, and copies and moves carry them out rather than taking
+ * them over, so a world holding pending steps was never defined const. Const reads of a lazy world with pending
+ * steps do write to it though, so they must not be made from several threads at once.
+ */
+void World::settle() const{
+    if(pending_steps > 0){
+        const_cast<World *>(this)->flush();
+    }
+}
+
+/**
+ * World::flush()
  *
- * Rules: https://en.wikipedia.org/wiki/Conway%27s_Game_of_Life
- *      - Any live cell with fewer than two live neighbours dies, as if by underpopulation.
- *      - Any live cell with two or three live neighbours lives on to the next generation.
- *      - Any live cell with more than three live neighbours dies, as if by overpopulation.
- *      - Any dead cell with exactly three live neighbours becomes a live cell, as if by reproduction.
+ * Private helper that carries out the pending lazy steps as one run.
+ */
+void World::flush(){
+    const int steps = pending_steps;
+    pending_steps = 0;
+    (this->*pending_advance)(steps);
+}
+
+/**
+ * World::drop_pending()
  *
- * @param toroidal
- *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
- *      wraps to the right edge and the top to the bottom. Defaults to false.
+ * Private helper that forgets the pending lazy steps before the state is overwritten, still counting them as
+ * generations that passed.
  */
-void World::step(bool toroidal){
-    int width = get_width(); // Get width to save computation
-    int height = get_height(); // Get height to save computation
-
-    for (int y = 0; y<height; y++){
-        for (int x = 0; x<width; x++) {
-            if (count_neighbours(x, y, toroidal) < 2 || count_neighbours(x, y, toroidal) > 3) { // Case 1
-                next_world.set(x, y, Cell::DEAD);
-            } else if (count_neighbours(x, y, toroidal) == 3) { // Case 4 & 2
-                next_world.set(x, y, Cell::ALIVE);
-            } else if (count_neighbours(x, y, toroidal) == 2 && cur_world.get(x, y) == Cell::ALIVE) { // Case 2
-                next_world.set(x, y, Cell::ALIVE);
-            } else {
-                next_world.set(x, y, Cell::DEAD);
-            }
-        }
+void World::drop_pending(){
+    generation += pending_steps;
+    pending_steps = 0;
+}
+
+/**
+ * World::set_config(config)
+ *
+ * Set how the world splits up each step, the number of threads and the height of the bands of rows they work on.
+ * The results of a step do not depend on the configuration, only how fast it runs.
+ * Turning on StepConfig::numa copies the current state into freshly placed storage, see World::place_bands.
+ *
+ * @example
+ *
+ *      // Make a world
+ *      World world(4096);
+ *
+ *      // Step with 4 threads working through bands of 64 rows
+ *      world.set_config({4, 64});
+ *
+ * @param new_config
+ *      The configuration to use.
+ *
+ * @throws
+ *      std::runtime_error if the thread count is less than 1 or the band height is negative.
+ */
+void World::set_config(const StepConfig &new_config){
+    if(new_config.threads < 1 || new_config.band_rows < 0){
+        throw std::runtime_error("World::set_config() : Needs at least one thread and a band height of 0 or more");
     }
+    // Turning on numa mode, or changing its thread count, moves the bands to their new owners
+    const bool replace = new_config.numa && (!config.numa || new_config.threads != config.threads);
+    if(new_config.threads != config.threads || new_config.numa != config.numa){
+        pool.reset();
+    }
+    config = new_config;
+    if((config.threads > 1 || config.numa) && !pool){
+        pool = std::make_unique<BandPool>(config.threads, config.numa);
+    }
+    if(replace){
+        place_bands();
+    }
+}
 
-    std::swap(cur_world, next_world);
+/**
+ * World::prepare_clip()
+ *
+ * Private helper that readies a step bounded by dead edges to only visit the cells that can change. Only the
+ * cells within one of an alive cell can change, so the step covers the live bounding box grown by one cell.
+ * The region is written in full, but whatever the next state grid holds outside it must be dead, so the cells
+ * left there by the generation before, within next_box, are cleared first. When those bounds are not known the
+ * whole next state grid is cleared, and when the live bounds are not known the board is scanned for them, once.
+ *
+ * @return
+ *      The region to step.
+ */
+World::Box World::prepare_clip(){
+    const int width = get_width();
+    const int height = get_height();
+    if(!live_box_valid){
+        live_box = find_box(cur_world, {0, 0, width, height});
+        live_box_valid = true;
+    }
+
+    const Box clear = next_box_valid ? next_box : Box{0, 0, width, height};
+    for(int y = clear.y0; y < clear.y1 && clear.x0 < clear.x1; y++){
+        std::fill(&next_world(clear.x0, y), &next_world(clear.x0, y) + (clear.x1 - clear.x0), Cell::DEAD);
+    }
+
+    if(live_box.x0 == live_box.x1){
+        return Box{};
+    }
+    return Box{std::max(live_box.x0 - 1, 0), std::max(live_box.y0 - 1, 0),
+               std::min(live_box.x1 + 1, width), std::min(live_box.y1 + 1, height)};
 }
 
 /**
- * World::advance(steps, toroidal)
+ * World::find_box(state, region)
  *
- * Advance multiple steps in the Game of Life.
- * Should be implemented by invoking World::step(toroidal).
+ * Private helper that finds the bounds of the alive cells within a region of a grid, see GridView::occupied.
  *
- * @param steps
- *      The number of steps to advance the world forward.
+ * @param state
+ *      The grid to search.
  *
- * @param toroidal
- *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
- *      wraps to the right edge and the top to the bottom. Defaults to false.
+ * @param region
+ *      The region to search, every alive cell of the grid must be inside it.
+ *
+ * @return
+ *      The smallest box holding every alive cell, empty if there are none.
  */
-void World::advance(int steps, bool toroidal){
-    for (int i = 0; i<steps; i++){
-        World::step(toroidal);
+World::Box World::find_box(const Grid &state, const Box &region){
+    const GridView occupied = state.view(region.x0, region.y0, region.x1, region.y1).occupied();
+    if(occupied.get_total_cells() == 0){
+        return Box{};
+    }
+    // The occupied view shares the grid's cells, so its offset into them gives its position
+    const std::ptrdiff_t offset = &occupied(0, 0) - &state(0, 0);
+    const int x0 = static_cast<int>(offset % state.get_width());
+    const int y0 = static_cast<int>(offset / state.get_width());
+    return Box{x0, y0, x0 + occupied.get_width(), y0 + occupied.get_height()};
+}
+
+/**
+ * World::place_bands()
+ *
+ * Private helper that first touches both state grids in the bands numa mode steps them in, so each band's pages
+ * are placed on the memory node of the pinned thread that owns it. The current state is copied into fresh storage
+ * and the next state is reallocated, any wavefront buffers are released.
+ */
+void World::place_bands(){
+    cur_world.first_touch(band_pool());
+    if(!in_place){
+        next_world = Grid(); // Release the old buffer before placing the new one
+        next_world = Grid(get_width(), get_height(), band_pool());
     }
-}
\ No newline at end of file
+    next_box_valid = false;
+}
+
+/**
+ * World::band_pool()
+ *
+ * Private helper for the threads that work through the bands of a step. They are started by World::set_config
+ * and kept until the thread count or numa mode changes, a copied world starts its own on its first step.
+ * In numa mode the threads are pinned, and the same thread places and steps each band.
+ *
+ * @return
+ *      The pool, with StepConfig::threads threads.
+ */
+BandPool &World::band_pool(){
+    if(!pool){
+        pool = std::make_unique<BandPool>(config.threads, config.numa);
+    }
+    return *pool;
+}
+
+/**
+ * World::get_config()
+ *
+ * @return
+ *      The configuration used to split up each step.
+ */
+const StepConfig& World::get_config() const{
+    return config;
+}
+
+/**
+ * World::set_in_place(enabled)
+ *
+ * Switch in place stepping on or off.
+ *
+ * In place stepping writes each new generation straight back into the current state grid, keeping only a few
+ * saved rows rather than the whole next state grid, which is released. This nearly halves the memory a world
+ * uses, at the cost of stepping on a single thread. Switching back off allocates the next state grid again
+ * on the next step.
+ *
+ * @example
+ *
+ *      // Make a world as large as memory allows and step it without a second buffer
+ *      World world(Zoo::load_ascii("path/to/huge.gol"));
+ *      world.set_in_place(true);
+ *      world.advance(100);
+ *
+ * @param enabled
+ *      If true then steps write back into the current state grid.
+ */
+void World::set_in_place(const bool enabled){
+    in_place = enabled;
+    next_box_valid = false;
+    if(in_place){
+        next_world = Grid();
+    } else if(config.numa && next_world.get_total_cells() != cur_world.get_total_cells()){
+        next_world = Grid(get_width(), get_height(), band_pool());
+    }
+}
+
+/**
+ * World::is_in_place()
+ *
+ * @return
+ *      True if the world is stepping in place.
+ */
+bool World::is_in_place() const{
+    return in_place;
+}
+
+/**
+ * World::set_event_driven(enabled)
+ *
+ * Switch event driven stepping on or off.
+ *
+ * In event driven mode the world remembers which cells changed in the last generation. A cell can only change
+ * if something in its 3x3 neighbourhood changed, so each step only evaluates the cells next to last generation's
+ * changes and flips the ones that change in place. The cost of a step scales with the number of changed cells
+ * rather than the size of the board, which suits a few moving objects on a huge, mostly still board.
+ *
+ * The first event driven step after switching on, or after the state is changed from outside (resizing,
+ * replacing the state, or changing the boundary), evaluates every cell once to rebuild the list of changes.
+ *
+ * @example
+ *
+ *      // Make a big mostly empty world with one glider in it
+ *      Grid grid(10000);
+ *      grid.merge(Zoo::glider(), 10, 10, true);
+ *      World world(std::move(grid));
+ *
+ *      // Only the cells around the glider are evaluated each step
+ *      world.set_event_driven(true);
+ *      world.advance(1000);
+ *
+ * @param enabled
+ *      If true then steps only evaluate the cells around the last generation's changes.
+ */
+void World::set_event_driven(const bool enabled){
+    event_driven = enabled;
+    changes_valid = false;
+    if(!enabled){
+        // Later steps do not fill these in, so they must not keep describing an old one
+        births.clear();
+        deaths.clear();
+    }
+}
+
+/**
+ * World::is_event_driven()
+ *
+ * @return
+ *      True if the world is stepping in event driven mode.
+ */
+bool World::is_event_driven() const{
+    return event_driven;
+}
+
+/**
+ * World::get_births()
+ *
+ * The cells that came alive in the last event driven step.
+ *
+ * @example
+ *
+ *      // Print where cells were born in the last step
+ *      for(const auto &cell : world.get_births()){
+ *          std::cout << cell.first << ", " << cell.second << std::endl;
+ *      }
+ *
+ * @return
+ *      The x, y coordinates of every birth, empty unless the last step was event driven.
+ */
+const std::vector<std::pair<int, int>>& World::get_births() const{
+    settle();
+    return births;
+}
+
+/**
+ * World::get_deaths()
+ *
+ * The cells that died in the last event driven step.
+ *
+ * @return
+ *      The x, y coordinates of every death, empty unless the last step was event driven.
+ */
+const std::vector<std::pair<int, int>>& World::get_deaths() const{
+    settle();
+    return deaths;
+}
+
+/**
+ * cpu_model()
+ *
+ * Helper returning the model name of the processor, used as part of the key for tuned configurations.
+ *
+ * @return
+ *      The model name from /proc/cpuinfo, or "unknown" if it cannot be read.
+ */
+static std::string cpu_model(){
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while(std::getline(cpuinfo, line)){
+        if(line.rfind("model name", 0) == 0 && line.find(':') != std::string::npos){
+            return line.substr(line.find(':') + 2);
+        }
+    }
+    return "unknown";
+}
+
+/**
+ * World::calibrate(budget, profile_path, toroidal = false)
+ *
+ * Pick the fastest step configuration for this world on this machine.
+ *
+ * If the profile file already holds a configuration for this processor model and board size it is used straight
+ * away. Otherwise candidate thread counts, band heights and wavefront pipelining are each timed on a sample of the current board, a
+ * band of full width rows from its middle, sharing the time budget between them. Every candidate starts from the same
+ * sample and steps it with the boundary the run will use. The fastest is kept and appended to the profile so later
+ * runs start already tuned.
+ *
+ * @example
+ *
+ *      // Load a big board and tune for it, remembering the answer in a local file
+ *      World world(Zoo::load_ascii("path/to/file.gol"));
+ *      world.calibrate(std::chrono::milliseconds(50), "gol_tuning.txt");
+ *
+ * @param budget
+ *      Optional parameter. Roughly how long to spend timing candidates. Defaults to 50ms.
+ *
+ * @param profile_path
+ *      Optional parameter. The file to look up and store tuned configurations in. If empty the
+ *      candidates are always timed and nothing is stored. Defaults to empty.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the candidates are timed stepping the sample as a torus. Defaults to false.
+ *
+ * @return
+ *      The chosen configuration, which is also applied to the world.
+ */
+StepConfig World::calibrate(const std::chrono::milliseconds budget, const std::string &profile_path, const bool toroidal){
+    settle();
+    const std::string cpu = cpu_model();
+    const int width = get_width();
+    const int height = get_height();
+
+    // Profile lines are: cpu model, then width, height, threads, band rows, wavefront and toroidal separated by spaces
+    if(!profile_path.empty()){
+        std::ifstream profile(profile_path);
+        std::string line;
+        while(std::getline(profile, line)){
+            std::istringstream fields(line);
+            std::string model;
+            int profile_width, profile_height;
+            bool profile_toroidal;
+            StepConfig tuned;
+            if(std::getline(fields, model, '\t') && fields >> profile_width >> profile_height >> tuned.threads >> tuned.band_rows >> tuned.wavefront >> profile_toroidal
+               && model == cpu && profile_width == width && profile_height == height && profile_toroidal == toroidal && tuned.threads >= 1){
+                tuned.numa = config.numa;
+                set_config(tuned);
+                return config;
+            }
+        }
+    }
+
+    // Time on full width rows from the middle of the board, about 4 million cells' worth but never fewer than 64
+    // rows so every candidate has bands to split, which makes the sample larger on boards over 65536 cells wide
+    const int sample_rows = std::min(height, std::max(64, (1 << 22) / std::max(width, 1)));
+    const int sample_top = (height - sample_rows) / 2;
+    const Grid sample_state = cur_world.crop(0, sample_top, width, sample_top + sample_rows);
+
+    // Candidate thread counts double up to the hardware limit, each with a few band heights
+    std::vector<StepConfig> candidates;
+    const int hardware_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    for(int threads = 1; threads <= hardware_threads; threads *= 2){
+        for(const int band_rows : {0, 16, 64, 256}){
+            if(threads == 1 && band_rows != 0){
+                continue; // A single thread works through the rows in order whatever the band height
+            }
+            candidates.push_back({threads, band_rows, false});
+        }
+        if(threads > 1){
+            candidates.push_back({threads, 0, true});
+        }
+    }
+
+    const auto slice = budget / static_cast<int>(candidates.size());
+    StepConfig best = candidates.front();
+    double best_rate = -1;
+    for(const StepConfig &candidate : candidates){
+        // A fresh copy each time, a sample stepped by the candidates before would have died down or shrunk
+        World sample(sample_state);
+        sample.set_config(candidate);
+
+        // Always take at least one chunk so every candidate gets a measurement. A wavefront pipelines at most one
+        // generation per thread of a call, so its chunks are long enough to put every thread to work
+        const int chunk = candidate.wavefront ? std::max(4, candidate.threads + 1) : 4;
+        int generations = 0;
+        const auto start = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::steady_clock::duration::zero();
+        do {
+            sample.advance(chunk, toroidal);
+            generations += chunk;
+            elapsed = std::chrono::steady_clock::now() - start;
+        } while(elapsed < slice);
+
+        const double rate = generations / std::chrono::duration<double>(elapsed).count();
+        if(rate > best_rate){
+            best_rate = rate;
+            best = candidate;
+        }
+    }
+
+    // Memory placement is the caller's choice, not something the sample can measure
+    best.numa = config.numa;
+    set_config(best);
+
+    if(!profile_path.empty()){
+        std::ofstream profile(profile_path, std::ofstream::app);
+        if(profile){
+            profile << cpu << '\t' << width << ' ' << height << ' ' << best.threads << ' ' << best.band_rows << ' ' << best.wavefront << ' ' << toroidal << std::endl;
+        }
+    }
+    return config;
+}
+
+/**
+ * DeadBoundary
+ *
+ * Boundary policy where everything outside the grid is Cell::DEAD.
+ * A boundary policy maps a neighbour coordinate that may be one step outside the grid to the
+ * coordinate of the stored cell it reads from, or -1 if the neighbour is always dead.
+ */
+struct DeadBoundary {
+    static int column(const int x, const int width){
+        return (x < 0 || x >= width) ? -1 : x;
+    }
+    static int row(const int y, const int height){
+        return (y < 0 || y >= height) ? -1 : y;
+    }
+};
+
+/**
+ * ToroidalBoundary
+ *
+ * Boundary policy for a torus.
+ *      - Moving off the left edge you appear on the right edge and vice versa.
+ *      - Moving off the top edge you appear on the bottom edge and vice versa.
+ */
+struct ToroidalBoundary {
+    static int column(const int x, const int width){
+        return (x < 0) ? width - 1 : (x >= width) ? 0 : x;
+    }
+    static int row(const int y, const int height){
+        return (y < 0) ? height - 1 : (y >= height) ? 0 : y;
+    }
+};
+
+/**
+ * CylinderBoundary
+ *
+ * Boundary policy for a cylinder, the left and right edges wrap while above the top and below the bottom are dead.
+ */
+struct CylinderBoundary {
+    static int column(const int x, const int width){
+        return ToroidalBoundary::column(x, width);
+    }
+    static int row(const int y, const int height){
+        return DeadBoundary::row(y, height);
+    }
+};
+
+/**
+ * tally_row(before, after, x_begin, x_end, width, y, stats)
+ *
+ * Helper adding one freshly written row to the stats of a step. The row and its previous values were just
+ * touched by the step, so they are read again from cache rather than memory.
+ *
+ * @param before
+ *      The row in the previous generation.
+ *
+ * @param after
+ *      The row in the new generation.
+ *
+ * @param x_begin
+ *      The first column to add.
+ *
+ * @param x_end
+ *      One past the last column to add.
+ *
+ * @param width
+ *      The length of the rows.
+ *
+ * @param y
+ *      The row's position in the grid.
+ *
+ * @param stats
+ *      The stats to add to.
+ */
+static void tally_row(const Cell *before, const Cell *after, const int x_begin, const int x_end, const int width,
+                      const int y, StepStats &stats){
+    std::int64_t births = 0;
+    std::int64_t deaths = 0;
+    int first = -1;
+    int last = -1;
+    for(int x = x_begin; x < x_end; x++){
+        const bool was_alive = before[x] == Cell::ALIVE;
+        const bool is_alive = after[x] == Cell::ALIVE;
+        births += is_alive && !was_alive;
+        deaths += was_alive && !is_alive;
+        if(is_alive){
+            first = (first < 0) ? x : first;
+            last = x;
+
+            // A sum of mixed cell indices (splitmix64) does not depend on the order the rows are added in
+            std::uint64_t mixed = static_cast<std::uint64_t>(y) * static_cast<std::uint64_t>(width) + x + 0x9e3779b97f4a7c15ULL;
+            mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+            stats.hash += mixed ^ (mixed >> 31);
+            stats.population++;
+        }
+    }
+    stats.births += births;
+    stats.deaths += deaths;
+    if(first >= 0){
+        stats.min_x = (stats.min_x < 0) ? first : std::min(stats.min_x, first);
+        stats.max_x = std::max(stats.max_x, last);
+        stats.min_y = (stats.min_y < 0) ? y : std::min(stats.min_y, y);
+        stats.max_y = std::max(stats.max_y, y);
+    }
+}
+
+/**
+ * add_stats(total, part)
+ *
+ * Helper combining the stats of one band of rows into the stats of the whole step.
+ *
+ * @param total
+ *      The stats to add to.
+ *
+ * @param part
+ *      The stats of the band.
+ */
+static void add_stats(StepStats &total, const StepStats &part){
+    total.births += part.births;
+    total.deaths += part.deaths;
+    total.population += part.population;
+    total.hash += part.hash;
+    if(part.min_x >= 0){
+        total.min_x = (total.min_x < 0) ? part.min_x : std::min(total.min_x, part.min_x);
+        total.min_y = (total.min_y < 0) ? part.min_y : std::min(total.min_y, part.min_y);
+        total.max_x = std::max(total.max_x, part.max_x);
+        total.max_y = std::max(total.max_y, part.max_y);
+    }
+}
+
+/**
+ * World::count_neighbours<Boundary>(state, x, y)
+ *
+ * Private helper function to count the number of alive neighbours of a cell.
+ * The function should not be visible from outside the World class.
+ *
+ * Neighbours are considered within the 3x3 square centred around the cell at x,y in the given state grid,
+ * which is the current state grid except while pipelining generations in World::advance.
+ * Ignore the centre coordinate, a cell is not its own neighbour.
+ * Neighbours outside of the grid are resolved by the Boundary policy, DeadBoundary skips them
+ * while ToroidalBoundary wraps them to the opposite side of the grid.
+ *
+ * This function is in World and not Grid because the 3x3 sized neighbourhood is specific to Conway's Game of Life,
+ * while Grid is more generic to any 2D grid based cellular automaton.
+ *
+ * @tparam Boundary
+ *      The boundary policy deciding what lies beyond the edges of the grid.
+ *
+ * @param state
+ *      The grid to count neighbours in.
+ *
+ * @param x
+ *      The x coordinate of the centre of the neighbourhood.
+ *
+ * @param y
+ *      The y coordinate of the centre of the neighbourhood.
+ *
+ * @return
+ *      Returns the number of alive neighbours.
+ */
+template <typename Boundary>
+int World::count_neighbours(const Grid &state, const int x, const int y) const{
+    const int width = get_width(); // Get width to save computation
+    const int height = get_height(); // Get height to save computation
+
+    int alive = 0; // Count number of alive cells
+
+    for(int y_pos = y - 1; y_pos <= y + 1; y_pos++){
+        const int use_y = Boundary::row(y_pos, height);
+        if(use_y < 0){
+            continue;
+        }
+        for(int x_pos = x - 1; x_pos <= x + 1; x_pos++){
+            const int use_x = Boundary::column(x_pos, width);
+            if(use_x >= 0 && state(use_x, use_y) == Cell::ALIVE){
+                alive++;
+            }
+        }
+    }
+
+    // As this method counts the centre cell its easier to just remove it at the end if it is alive.
+    if(state(x, y) == Cell::ALIVE){
+        alive--;
+    }
+    return alive;
+}
+
+/**
+ * World::step_row<Boundary>(above, centre, below, next, x_begin, x_end)
+ *
+ * Private helper that writes the columns [x_begin, x_end) of one row of the next generation from the three rows
+ * around it.
+ *
+ * Each boundary policy gets its own copy of this loop. The interior columns are counted with fixed offsets
+ * and no boundary checks, only the first and last column map their neighbours through the policy.
+ * The output row must not be any of the input rows.
+ *
+ * @tparam Boundary
+ *      The boundary policy deciding what lies beyond the edges of the grid.
+ *
+ * @param above
+ *      The row above in the current generation, or a dead row beyond a dead edge.
+ *
+ * @param centre
+ *      The row itself in the current generation.
+ *
+ * @param below
+ *      The row below in the current generation, or a dead row beyond a dead edge.
+ *
+ * @param next
+ *      Where to write the row in the next generation.
+ *
+ * @param x_begin
+ *      The first column to write.
+ *
+ * @param x_end
+ *      One past the last column to write.
+ */
+template <typename Boundary>
+void World::step_row(const Cell *above, const Cell *centre, const Cell *below, Cell *next,
+                     const int x_begin, const int x_end) const{
+    const int width = get_width(); // Get width to save computation
+
+    const int interior_end = std::min(x_end, width - 1);
+    for(int x = std::max(x_begin, 1); x < interior_end; x++){
+        const int alive = (above[x - 1] == Cell::ALIVE) + (above[x] == Cell::ALIVE) + (above[x + 1] == Cell::ALIVE)
+                        + (centre[x - 1] == Cell::ALIVE)                              + (centre[x + 1] == Cell::ALIVE)
+                        + (below[x - 1] == Cell::ALIVE) + (below[x] == Cell::ALIVE) + (below[x + 1] == Cell::ALIVE);
+
+        // Exactly 3 neighbours is a birth or survival, 2 neighbours only keeps an alive cell alive
+        next[x] = (alive == 3 || (alive == 2 && centre[x] == Cell::ALIVE)) ? Cell::ALIVE : Cell::DEAD;
+    }
+
+    // The edge columns may wrap so go the long way round
+    const auto alive_at = [width](const Cell *row, const int x){
+        const int use_x = Boundary::column(x, width);
+        return (use_x >= 0 && row[use_x] == Cell::ALIVE) ? 1 : 0;
+    };
+    for(const int x : {0, width - 1}){
+        if(x < x_begin || x >= x_end){
+            continue;
+        }
+        const int alive = alive_at(above, x - 1) + alive_at(above, x) + alive_at(above, x + 1)
+                        + alive_at(centre, x - 1)                      + alive_at(centre, x + 1)
+                        + alive_at(below, x - 1) + alive_at(below, x) + alive_at(below, x + 1);
+        next[x] = (alive == 3 || (alive == 2 && centre[x] == Cell::ALIVE)) ? Cell::ALIVE : Cell::DEAD;
+    }
+}
+
+/**
+ * World::step_rows<Boundary>(from, to, y_begin, y_end, x_begin, x_end, stats = nullptr)
+ *
+ * Private helper that writes the rows [y_begin, y_end) of the generation after from into to, across the
+ * columns [x_begin, x_end).
+ *
+ * The rows above and below are looked up once per row, a dead row stands in for rows outside the grid.
+ * The dead row must already be sized to the width. Different row ranges can be written from different threads.
+ *
+ * @tparam Boundary
+ *      The boundary policy deciding what lies beyond the edges of the grid.
+ *
+ * @param from
+ *      The generation to read, the current state grid for a normal step.
+ *
+ * @param to
+ *      The grid to write the next generation into, the same size as from.
+ *
+ * @param y_begin
+ *      The first row to write.
+ *
+ * @param y_end
+ *      One past the last row to write.
+ *
+ * @param x_begin
+ *      The first column to write.
+ *
+ * @param x_end
+ *      One past the last column to write.
+ *
+ * @param stats
+ *      Optional parameter. If not null each row is added to these stats as soon as it is written.
+ */
+template <typename Boundary>
+void World::step_rows(const Grid &from, Grid &to, const int y_begin, const int y_end, const int x_begin, const int x_end,
+                      StepStats *stats) const{
+    const int height = get_height(); // Get height to save computation
+
+    if(get_width() == 0){
+        return;
+    }
+
+    for(int y = y_begin; y < y_end; y++){
+        const int above_y = Boundary::row(y - 1, height);
+        const int below_y = Boundary::row(y + 1, height);
+
+        const Cell *above = (above_y < 0) ? dead_row.data() : &from(0, above_y);
+        const Cell *below = (below_y < 0) ? dead_row.data() : &from(0, below_y);
+        step_row<Boundary>(above, &from(0, y), below, &to(0, y), x_begin, x_end);
+        if(stats != nullptr){
+            tally_row(&from(0, y), &to(0, y), x_begin, x_end, get_width(), y, *stats);
+        }
+    }
+}
+
+/**
+ * World::step_in_place<Boundary>(stats)
+ *
+ * Private helper that takes one step writing straight back into the current state grid, see World::set_in_place.
+ *
+ * Going down the rows, only the original copies of the row being written and the row above it are still needed
+ * once they are overwritten, so they are kept in two rolling row buffers. The row below has not been written yet.
+ * The original first row is also kept, for the last row to read when the rows wrap.
+ *
+ * @tparam Boundary
+ *      The boundary policy deciding what lies beyond the edges of the grid.
+ *
+ * @param stats
+ *      If not null each row is added to these stats as soon as it is written.
+ */
+template <typename Boundary>
+void World::step_in_place(StepStats *stats){
+    const int width = get_width();
+    const int height = get_height();
+
+    if(width == 0 || height == 0){
+        return;
+    }
+
+    // Rows that fall outside the grid read as all dead
+    dead_row.assign(width, Cell::DEAD);
+
+    const Cell *first = &cur_world(0, 0);
+    saved_rows[0].assign(first, first + width); // The original row above the one being written
+    saved_rows[1].assign(first, first + width); // The original row being written
+    saved_rows[2].assign(first, first + width); // The original first row
+
+    for(int y = 0; y < height; y++){
+        if(y > 0){
+            // Roll the window down, saving this row before it is overwritten
+            std::swap(saved_rows[0], saved_rows[1]);
+            const Cell *row = &cur_world(0, y);
+            std::copy(row, row + width, saved_rows[1].begin());
+        }
+
+        // Rows above this one have been overwritten, so read their saved originals
+        const auto original_row = [&](const int row_y) -> const Cell *{
+            if(row_y < 0){
+                return dead_row.data();
+            } else if(row_y == y){
+                return saved_rows[1].data();
+            } else if(row_y == y - 1){
+                return saved_rows[0].data();
+            } else if(row_y < y){
+                return saved_rows[2].data(); // Only the wrapped first row can be needed from further up
+            }
+            return &cur_world(0, row_y);
+        };
+
+        step_row<Boundary>(original_row(Boundary::row(y - 1, height)), saved_rows[1].data(),
+                           original_row(Boundary::row(y + 1, height)), &cur_world(0, y), 0, width);
+        if(stats != nullptr){
+            tally_row(saved_rows[1].data(), &cur_world(0, y), 0, width, width, y, *stats);
+        }
+    }
+}
+
+/**
+ * World::step_changes<Boundary>()
+ *
+ * Private helper that takes one event driven step, see World::set_event_driven.
+ *
+ * The candidates are every cell within one step of a change in the last generation, mapped through the
+ * boundary policy and deduplicated by sorting. Every candidate is evaluated against the current state before
+ * any of them are flipped, so the flips can be applied straight to the current state grid without the
+ * next state grid. The flipped cells become the change list for the following step. When there is no change
+ * list to go on, every cell is evaluated in order without building a candidate list.
+ *
+ * @tparam Boundary
+ *      The boundary policy deciding what lies beyond the edges of the grid.
+ */
+template <typename Boundary>
+void World::step_changes(){
+    const int width = get_width();
+    const int height = get_height();
+
+    // Changes from a different boundary or an outside edit say nothing about this step, so look at everything.
+    // Every cell is then visited straight from the grid, as a candidate list would take 8 bytes a cell.
+    const std::type_index boundary = typeid(Boundary);
+    const bool everything = !changes_valid || changes_boundary != boundary;
+    candidates.clear();
+    if(everything){
+        candidates.shrink_to_fit();
+    } else {
+        for(const std::size_t index : changes){
+            const int x = static_cast<int>(index % width);
+            const int y = static_cast<int>(index / width);
+            for(int y_pos = y - 1; y_pos <= y + 1; y_pos++){
+                const int use_y = Boundary::row(y_pos, height);
+                for(int x_pos = x - 1; x_pos <= x + 1; x_pos++){
+                    const int use_x = Boundary::column(x_pos, width);
+                    if(use_x >= 0 && use_y >= 0){
+                        candidates.push_back(static_cast<std::size_t>(use_y) * width + use_x);
+                    }
+                }
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    }
+
+    // Work out every flip before applying any of them
+    changes.clear();
+    births.clear();
+    deaths.clear();
+    const auto evaluate = [this, width](const std::size_t index){
+        const int x = static_cast<int>(index % width);
+        const int y = static_cast<int>(index / width);
+        const int alive = count_neighbours<Boundary>(cur_world, x, y);
+        const bool was_alive = cur_world(x, y) == Cell::ALIVE;
+        const bool lives = (alive == 3 || (alive == 2 && was_alive));
+        if(lives != was_alive){
+            changes.push_back(index);
+            (lives ? births : deaths).emplace_back(x, y);
+        }
+    };
+    if(everything){
+        const std::size_t cells = static_cast<std::size_t>(width) * height;
+        for(std::size_t index = 0; index < cells; index++){
+            evaluate(index);
+        }
+    } else {
+        for(const std::size_t index : candidates){
+            evaluate(index);
+        }
+    }
+
+    for(const std::size_t index : changes){
+        Cell &cell = cur_world(static_cast<int>(index % width), static_cast<int>(index / width));
+        cell = (cell == Cell::ALIVE) ? Cell::DEAD : Cell::ALIVE;
+    }
+
+    changes_valid = true;
+    changes_boundary = boundary;
+}
+
+/**
+ * World::step(toroidal)
+ *
+ * Take one step in Conway's Game of Life.
+ *
+ * Reads from the current state grid and writes to the next state grid. Then swaps the grids.
+ * The rows are split into bands across threads as set by World::set_config.
+ * Swapping the grids should be done in O(1) constant time, and should not invoke a copy.
+ *
+ * Rules: https://en.wikipedia.org/wiki/Conway%27s_Game_of_Life
+ *      - Any live cell with fewer than two live neighbours dies, as if by underpopulation.
+ *      - Any live cell with two or three live neighbours lives on to the next generation.
+ *      - Any live cell with more than three live neighbours dies, as if by overpopulation.
+ *      - Any dead cell with exactly three live neighbours becomes a live cell, as if by reproduction.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom. Defaults to false.
+ */
+void World::step(bool toroidal){
+    // Pick the specialised loop once rather than checking the flag for every neighbour
+    if(toroidal){
+        step<ToroidalBoundary>();
+    } else {
+        step<DeadBoundary>();
+    }
+}
+
+/**
+ * World::step<Boundary>()
+ *
+ * Take one step in Conway's Game of Life using a boundary policy chosen at compile time.
+ * Available policies are DeadBoundary, ToroidalBoundary and CylinderBoundary.
+ *
+ * @example
+ *
+ *      // Make a world
+ *      World world(Zoo::glider());
+ *
+ *      // Step on a cylinder that only wraps left to right
+ *      world.step<CylinderBoundary>();
+ *
+ * @tparam Boundary
+ *      The boundary policy deciding what lies beyond the edges of the grid.
+ */
+template <typename Boundary>
+void World::step(){
+    if(lazy){
+        defer<Boundary>(1);
+        return;
+    }
+    step_generation<Boundary>();
+}
+
+/**
+ * World::step_generation<Boundary>(stats = nullptr)
+ *
+ * Private helper that takes one step straight away, recording it in the history if there is one.
+ *
+ * @tparam Boundary
+ *      The boundary policy deciding what lies beyond the edges of the grid.
+ *
+ * @param stats
+ *      Optional parameter. If not null these are filled in with what changed.
+ */
+template <typename Boundary>
+void World::step_generation(StepStats *stats){
+    snapshot_valid = false;
+    if(history.is_enabled()){
+        prepare_history();
+    }
+    step_state<Boundary>(stats);
+    generation++;
+    if(history.is_enabled()){
+        history.record(cur_world, generation);
+    }
+}
+
+/**
+ * World::step_state<Boundary>(stats)
+ *
+ * Private helper that computes the next generation into the current state, in whichever mode the world is set to.
+ *
+ * @tparam Boundary
+ *      The boundary policy deciding what lies beyond the edges of the grid.
+ *
+ * @param stats
+ *      If not null these are filled in with what changed, band by band as the rows are written.
+ */
+template <typename Boundary>
+void World::step_state(StepStats *stats){
+    if(event_driven || in_place){
+        live_box_valid = false;
+        next_box_valid = false;
+    }
+    if(event_driven){
+        step_changes<Boundary>();
+        if(stats != nullptr){
+            // Only the changed cells were visited, so the population and bounds take a pass of their own
+            for(int y = 0; y < get_height(); y++){
+                tally_row(&cur_world(0, y), &cur_world(0, y), 0, get_width(), get_width(), y, *stats);
+            }
+            stats->births = static_cast<std::int64_t>(births.size());
+            stats->deaths = static_cast<std::int64_t>(deaths.size());
+        }
+        return;
+    }
+    if(in_place){
+        step_in_place<Boundary>(stats);
+        return;
+    }
+
+    const int width = get_width();
+    const int height = get_height();
+    if(next_world.get_width() != width || next_world.get_height() != height){
+        next_world.resize(width, height);
+        next_box_valid = false;
+    }
+
+    // Rows that fall outside the grid read as all dead
+    dead_row.assign(width, Cell::DEAD);
+
+    // Past dead edges nothing can happen further than a cell from the live cells, so only step that region
+    Box region{0, 0, width, height};
+    const bool clip = Boundary::row(-1, height) < 0 && Boundary::column(-1, width) < 0 && !config.numa;
+    if(clip){
+        region = prepare_clip();
+    } else {
+        live_box_valid = false;
+        next_box_valid = false;
+    }
+    const int rows = region.y1 - region.y0;
+
+    // Split the rows into bands, handed out to the pool's threads as each one finishes its last band
+    const int threads = std::min(config.threads, std::max(rows, 1));
+    const int band_rows = (config.band_rows > 0) ? config.band_rows : std::max(1, (rows + threads - 1) / threads);
+
+    // Each thread gathers stats for its own rows, added together once they are done
+    std::vector<StepStats> thread_stats((stats != nullptr) ? config.threads : 0);
+    const auto stats_for = [&thread_stats](const int thread) -> StepStats *{
+        return thread_stats.empty() ? nullptr : &thread_stats[thread];
+    };
+
+    if(rows <= 0){
+        // No live cells, nothing to step
+    } else if(config.numa){
+        // Each pinned thread steps the one band whose pages it placed, split exactly as World::place_bands split them
+        band_pool().run([&](const int band){
+            const std::pair<int, int> own = Placement::band_rows(height, band, config.threads);
+            step_rows<Boundary>(cur_world, next_world, own.first, own.second, 0, width, stats_for(band));
+        });
+    } else if(threads <= 1){
+        step_rows<Boundary>(cur_world, next_world, region.y0, region.y1, region.x0, region.x1, stats_for(0));
+    } else {
+        std::atomic<int> next_band(region.y0);
+        band_pool().run([&](const int thread){
+            for(int y = next_band.fetch_add(band_rows); y < region.y1; y = next_band.fetch_add(band_rows)){
+                step_rows<Boundary>(cur_world, next_world, y, std::min(y + band_rows, region.y1), region.x0, region.x1,
+                                    stats_for(thread));
+            }
+        });
+    }
+    for(const StepStats &part : thread_stats){
+        add_stats(*stats, part);
+    }
+
+    std::swap(cur_world, next_world);
+    if(clip){
+        // The old generation's cells now sit in the next state grid, and the new cells can only be in the region
+        next_box = live_box;
+        next_box_valid = true;
+        live_box = find_box(cur_world, region);
+    }
+}
+
+/**
+ * World::step_with_stats(toroidal)
+ *
+ * Take one step and report what changed, see World::step_with_stats<Boundary>.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom. Defaults to false.
+ *
+ * @return
+ *      The births, deaths, population, bounding box and hash of the new generation.
+ */
+StepStats World::step_with_stats(const bool toroidal){
+    if(toroidal){
+        return step_with_stats<ToroidalBoundary>();
+    }
+    return step_with_stats<DeadBoundary>();
+}
+
+/**
+ * World::step_with_stats<Boundary>()
+ *
+ * Take one step and report what changed, gathered by each thread as it writes its rows. Each row is tallied
+ * straight after it is written, while it and the row it replaced are still in cache, so monitoring a run needs
+ * no extra passes over the grid. In event driven mode the population and bounds still take a pass of their own.
+ * Any pending lazy steps are run first.
+ *
+ * @example
+ *
+ *      // Watch a world settle down
+ *      World world(Zoo::load_ascii("path/to/file.gol"));
+ *      StepStats stats;
+ *      do {
+ *          stats = world.step_with_stats();
+ *      } while(stats.births + stats.deaths > 0);
+ *
+ * @tparam Boundary
+ *      The boundary policy deciding what lies beyond the edges of the grid.
+ *
+ * @return
+ *      The births, deaths, population, bounding box and hash of the new generation.
+ */
+template <typename Boundary>
+StepStats World::step_with_stats(){
+    settle();
+    StepStats stats;
+    step_generation<Boundary>(&stats);
+    return stats;
+}
+
+/**
+ * World::advance(steps, toroidal)
+ *
+ * Advance multiple steps in the Game of Life.
+ * Should be implemented by invoking World::step(toroidal).
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom. Defaults to false.
+ */
+void World::advance(int steps, bool toroidal){
+    if(toroidal){
+        advance<ToroidalBoundary>(steps);
+    } else {
+        advance<DeadBoundary>(steps);
+    }
+}
+
+/**
+ * World::advance<Boundary>(steps)
+ *
+ * Advance multiple steps in the Game of Life using a boundary policy chosen at compile time.
+ *
+ * In lazy mode the steps are only noted down, see World::set_lazy.
+ * In event driven mode every generation goes through World::step_changes.
+ * If the configuration asks for a wavefront with more than one thread, and the boundary does not wrap the top
+ * and bottom rows, the generations are pipelined through World::advance_wavefront instead of stepping one at a time.
+ *
+ * @tparam Boundary
+ *      The boundary policy deciding what lies beyond the edges of the grid.
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ */
+template <typename Boundary>
+void World::advance(const int steps){
+    if(lazy){
+        defer<Boundary>(steps);
+        return;
+    }
+    advance_now<Boundary>(steps);
+}
+
+/**
+ * World::advance_now<Boundary>(steps)
+ *
+ * Private helper that advances multiple steps straight away, as one run that World::advance_wavefront can pipeline.
+ *
+ * @tparam Boundary
+ *      The boundary policy deciding what lies beyond the edges of the grid.
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ */
+template <typename Boundary>
+void World::advance_now(const int steps){
+    // Row 0 of a generation needs the last row of the one before when the rows wrap, which stalls the pipeline
+    const bool rows_wrap = Boundary::row(-1, get_height()) >= 0;
+    if(!event_driven && !in_place && !history.is_enabled() && config.wavefront && !config.numa && config.threads > 1 && steps > 1 && !rows_wrap && get_width() > 0 && get_height() > 0){
+        snapshot_valid = false;
+        advance_wavefront<Boundary>(steps);
+        return;
+    }
+
+    for (int i = 0; i<steps; i++){
+        step_generation<Boundary>();
+    }
+}
+
+/**
+ * World::defer<Boundary>(steps)
+ *
+ * Private helper that adds steps to the pending run in lazy mode. A run for a different boundary is carried out
+ * first, as is one that would grow past the largest step count.
+ *
+ * @tparam Boundary
+ *      The boundary policy deciding what lies beyond the edges of the grid.
+ *
+ * @param steps
+ *      The number of steps to add.
+ */
+template <typename Boundary>
+void World::defer(const int steps){
+    if(steps <= 0){
+        return;
+    }
+    const PendingAdvance advance = &World::advance_now<Boundary>;
+    if(pending_steps > 0 && (pending_advance != advance || steps > std::numeric_limits<int>::max() - pending_steps)){
+        flush();
+    }
+    pending_advance = advance;
+    pending_steps += steps;
+}
+
+/**
+ * World::advance_wavefront<Boundary>(steps)
+ *
+ * Private helper that advances several generations at once with a pipeline of threads instead of
+ * a barrier after every generation.
+ *
+ * With P workers, worker k computes generations k+1, k+1+P, k+1+2P and so on. Each worker publishes how many
+ * rows it has finished through an atomic counter, and row y of a generation can be written as soon as rows
+ * y-1 to y+1 of the generation before are done. So worker k follows a couple of rows behind worker k-1,
+ * and every worker stays busy as long as the board has more rows than there are workers.
+ *
+ * The generations share the two usual grids, generation g living in grid g % 2, so the pipeline needs no more
+ * memory than a single step. Writing row y of generation g overwrites row y of generation g-2, which is only read
+ * for rows y-1 to y+1 of generation g-1. Those are the rows generation g waits for before it reads, so the wait
+ * that makes the inputs ready also makes the overwritten row free. The workers run on the World's BandPool.
+ *
+ * @tparam Boundary
+ *      The boundary policy deciding what lies beyond the edges of the grid, which must not wrap the rows.
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ */
+template <typename Boundary>
+void World::advance_wavefront(const int steps){
+    const int width = get_width();
+    const int height = get_height();
+    const int workers = std::min(config.threads, steps);
+
+    // Rows that fall outside the grid read as all dead
+    dead_row.assign(width, Cell::DEAD);
+
+    if(next_world.get_width() != width || next_world.get_height() != height){
+        next_world = Grid(width, height);
+    }
+    Grid *buffers[2] = {&cur_world, &next_world};
+
+    // The total rows each worker has written across all of its generations
+    std::unique_ptr<std::atomic<long long>[]> rows_written(new std::atomic<long long>[workers]);
+    for(int worker = 0; worker < workers; worker++){
+        rows_written[worker].store(0);
+    }
+
+    // How many rows of a generation are finished, generation 0 is the current state so is always complete
+    auto rows_done = [&](const int generation) -> long long{
+        if(generation == 0){
+            return height;
+        }
+        const long long written = rows_written[(generation - 1) % workers].load(std::memory_order_acquire);
+        const long long earlier = static_cast<long long>((generation - 1) / workers) * height;
+        return std::max(0LL, std::min(static_cast<long long>(height), written - earlier));
+    };
+
+    band_pool().run([&](const int worker){
+        for(int generation = worker + 1; worker < workers && generation <= steps; generation += workers){
+            const Grid &from = *buffers[(generation - 1) % 2];
+            Grid &to = *buffers[generation % 2];
+
+            for(int y = 0; y < height; y++){
+                // Wait for the rows this one reads from the previous generation, and which read the row it replaces
+                const long long needed = std::min(y + 2, height);
+                while(rows_done(generation - 1) < needed){
+                    std::this_thread::yield();
+                }
+                step_rows<Boundary>(from, to, y, y + 1, 0, width);
+                rows_written[worker].fetch_add(1, std::memory_order_release);
+            }
+        }
+    });
+
+    // Make the last generation the current state, swapping never copies
+    if(steps % 2 != 0){
+        std::swap(cur_world, next_world);
+    }
+    generation += steps;
+    live_box_valid = false;
+    next_box_valid = false;
+}
+
+// The boundary policies are only defined in this file, so instantiate the public templates for each of them
+template void World::step<DeadBoundary>();
+template void World::step<ToroidalBoundary>();
+template void World::step<CylinderBoundary>();
+template void World::advance<DeadBoundary>(int steps);
+template void World::advance<ToroidalBoundary>(int steps);
+template void World::advance<CylinderBoundary>(int steps);
+template StepStats World::step_with_stats<DeadBoundary>();
+template StepStats World::step_with_stats<ToroidalBoundary>();
+template StepStats World::step_with_stats<CylinderBoundary>();
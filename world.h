@@ -13,13 +13,69 @@
 // Add the minimal number of includes you need in order to declare the class.
 // #include ...
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <utility>
+#include <vector>
+#include "band_pool.h"
 #include "grid.h"
+#include "history.h"
+#include "snapshot.h"
+
+/**
+ * Boundary policies for stepping a World, defined in world.cpp.
+ *      - DeadBoundary treats everything outside the grid as dead.
+ *      - ToroidalBoundary wraps the left and right edges and the top and bottom edges.
+ *      - CylinderBoundary wraps the left and right edges only.
+ */
+struct DeadBoundary;
+struct ToroidalBoundary;
+struct CylinderBoundary;
+
+/**
+ * How a World splits up each step.
+ *      - threads is the number of threads updating rows at once.
+ *      - band_rows is the number of rows a thread takes at a time, 0 splits the rows evenly between the threads.
+ *      - wavefront pipelines the generations of World::advance across the threads instead of splitting each
+ *        generation into bands, for boundaries that do not wrap the top and bottom rows.
+ *      - numa gives each thread one fixed band pinned to its own CPUs, and places each band's pages on that
+ *        thread's NUMA node. band_rows is ignored and bands are never pipelined.
+ */
+struct StepConfig {
+    int threads = 1;
+    int band_rows = 0;
+    bool wavefront = false;
+    bool numa = false;
+};
+
+/**
+ * What changed in one generation, gathered while the generation is written, see World::step_with_stats.
+ *      - births and deaths count the cells that came alive and died.
+ *      - population is the number of alive cells afterwards.
+ *      - min_x, min_y, max_x and max_y bound the alive cells afterwards, inclusive, all -1 if there are none.
+ *      - hash is the same for equal states of the same width, whatever the step configuration.
+ */
+struct StepStats {
+    std::int64_t births = 0;
+    std::int64_t deaths = 0;
+    std::int64_t population = 0;
+    int min_x = -1;
+    int min_y = -1;
+    int max_x = -1;
+    int max_y = -1;
+    std::uint64_t hash = 0;
+};
 
 /**
  * Declare the structure of the World class for representing a 2d grid world.
  *
  * A World holds two equally sized Grid objects for the current state and next state.
  *      - These buffers should be swapped using std::swap after each update step.
+ *      - In place mode drops the next state and steps the current one using three saved rows.
  */
 class World {
     // How to draw an owl:
@@ -28,28 +84,123 @@ class World {
 private:
     Grid cur_world; // Current world
     Grid next_world; // Next world
-    [[nodiscard]] int count_neighbours(int x, int y, bool toroidal) const;
+    std::vector<Cell> dead_row; // Stands in for the rows beyond a dead edge
+    StepConfig config; // How each step is split up
+    std::unique_ptr<BandPool> pool; // Threads kept between steps to work through the bands, not copied
+    bool in_place = false; // Write each step back into the current world
+    std::vector<Cell> saved_rows[3]; // Original rows kept while stepping in place
+    bool event_driven = false; // Only evaluate the cells around the last changes
+    bool changes_valid = false; // Whether changes describe the last step
+    std::type_index changes_boundary = typeid(void); // The boundary the changes were found with
+    std::vector<std::size_t> changes; // Indices of the cells that flipped in the last step
+    std::vector<std::size_t> candidates; // Scratch list of the cells to evaluate
+    std::vector<std::pair<int, int>> births; // Cells that came alive in the last event driven step
+    std::vector<std::pair<int, int>> deaths; // Cells that died in the last event driven step
+    Snapshot last_snapshot; // The last snapshot taken or restored, later snapshots share its unchanged tiles
+    bool snapshot_valid = false; // Whether the current world still holds last_snapshot
+    std::int64_t generation = 0; // The number of steps taken
+    History history; // Recorded generations to seek between
+    bool history_valid = false; // Whether the current world is the generation the history says it is
+    struct Box {
+        int x0 = 0; // The box spans [x0, x1) by [y0, y1), empty when x0 == x1
+        int y0 = 0;
+        int x1 = 0;
+        int y1 = 0;
+    };
+    mutable Box live_box; // Bounds the alive cells of the current world
+    mutable bool live_box_valid = false;
+    Box next_box; // Bounds the alive cells left in the next world by the generation before
+    bool next_box_valid = false;
+    using PendingAdvance = void (World::*)(int);
+    bool lazy = false; // Note steps down and run them once the state is looked at
+    int pending_steps = 0; // Steps noted down but not yet run
+    PendingAdvance pending_advance = nullptr; // Runs the pending steps with the boundary they were asked for
+    template <typename Boundary> [[nodiscard]] int count_neighbours(const Grid &state, int x, int y) const;
+    template <typename Boundary> void step_row(const Cell *above, const Cell *centre, const Cell *below, Cell *next,
+                                               int x_begin, int x_end) const;
+    template <typename Boundary> void step_rows(const Grid &from, Grid &to, int y_begin, int y_end, int x_begin, int x_end,
+                                                StepStats *stats = nullptr) const;
+    template <typename Boundary> void step_generation(StepStats *stats = nullptr);
+    template <typename Boundary> void step_state(StepStats *stats);
+    template <typename Boundary> void step_in_place(StepStats *stats);
+    void place_bands();
+    [[nodiscard]] BandPool &band_pool();
+    void prepare_history();
+    template <typename Boundary> void advance_now(int steps);
+    template <typename Boundary> void advance_wavefront(int steps);
+    template <typename Boundary> void defer(int steps);
+    void settle() const;
+    [[nodiscard]] Box prepare_clip();
+    [[nodiscard]] static Box find_box(const Grid &state, const Box &region);
+    void flush();
+    void drop_pending();
+    template <typename Boundary> void step_changes();
 public:
     // Constructors & destructors
     World();
     explicit World(int square_size);
     World(int width, int height);
     explicit World(const Grid &initial_state);
+    explicit World(Grid &&initial_state);
+    World(const World &other);
+    World(World &&other);
     ~World() = default;
 
+    // Assignment
+    World& operator=(const World &other);
+    World& operator=(World &&other);
+
     // Getters
     [[nodiscard]] int get_width() const;
     [[nodiscard]] int get_height() const;
-    [[nodiscard]] int get_total_cells() const;
-    [[nodiscard]] int get_alive_cells() const;
-    [[nodiscard]] int get_dead_cells() const;
+    [[nodiscard]] std::int64_t get_total_cells() const;
+    [[nodiscard]] std::int64_t get_alive_cells() const;
+    [[nodiscard]] std::int64_t get_dead_cells() const;
     [[nodiscard]] const Grid& get_state() const;
+    [[nodiscard]] GridView occupied() const;
 
     // Manipulation
     void resize(int square_size);
     void resize(int width, int height);
+    [[nodiscard]] Grid take_state();
+    void replace_state(Grid &&state);
+
+    // Snapshots
+    [[nodiscard]] Snapshot snapshot();
+    void restore(const Snapshot &snapshot);
+
+    // History
+    void set_history(std::size_t budget_bytes, int keyframe_interval = 64);
+    [[nodiscard]] std::int64_t get_generation() const;
+    [[nodiscard]] std::pair<std::int64_t, std::int64_t> get_history_range() const;
+    void seek(std::int64_t target);
+
+    // Lazy stepping
+    void set_lazy(bool enabled);
+    [[nodiscard]] bool is_lazy() const;
+    [[nodiscard]] int get_pending_steps() const;
+
+    // Tuning
+    void set_config(const StepConfig &new_config);
+    [[nodiscard]] const StepConfig& get_config() const;
+    StepConfig calibrate(std::chrono::milliseconds budget = std::chrono::milliseconds(50),
+                         const std::string &profile_path = "", bool toroidal = false);
+
+    // In place stepping
+    void set_in_place(bool enabled);
+    [[nodiscard]] bool is_in_place() const;
+
+    // Event driven stepping
+    void set_event_driven(bool enabled);
+    [[nodiscard]] bool is_event_driven() const;
+    [[nodiscard]] const std::vector<std::pair<int, int>>& get_births() const;
+    [[nodiscard]] const std::vector<std::pair<int, int>>& get_deaths() const;
 
     // step functions
     void step(bool toroidal = false);
     void advance(int steps, bool toroidal = false);
+    template <typename Boundary> void step();
+    StepStats step_with_stats(bool toroidal = false);
+    template <typename Boundary> StepStats step_with_stats();
+    template <typename Boundary> void advance(int steps);
 };
\ No newline at end of file
@@ -16,6 +16,8 @@
  *              - a 4 byte int representing the grid height
  *              - followed by (width * height) number of individual bits in C-style row/column format,
  *                padded with zero or more 0 bits.
+ *              - bits are packed lowest bit first, so cell i is bit (i % 8) of byte (i / 8).
+ *              - the bit count is worked out in 64 bits, boards past 2^31 cells round trip.
  *              - a 0 bit should be considered Cell::DEAD, a 1 bit should be considered Cell::ALIVE.
  *
  * @author 951536
@@ -26,8 +28,10 @@
 // Include the minimal number of headers needed to support your implementation.
 // #include ...
 #include "grid.h"
+#include <algorithm>
+#include <cstdint>
 #include <fstream>
-#include <cmath>
+#include <vector>
 
 /**
  * Zoo::glider()
@@ -230,12 +234,12 @@ Grid Zoo::load_ascii(std::string const& path) {
  *      The std::string path to the file to write to.
  *
  * @param grid
- *      The grid to be written out to file.
+ *      The grid to be written out to file, or a view of part of a grid.
  *
  * @throws
  *      Throws std::runtime_error or sub-class if the file cannot be opened.
  */
-void Zoo::save_ascii(const std::string& path, const Grid& grid){
+void Zoo::save_ascii(const std::string& path, const GridView& grid){
     // open file
     std::ofstream write(path, std::ofstream::out);
     // fail if not opened
@@ -291,6 +295,7 @@ void Zoo::save_ascii(const std::string& path, const Grid& grid){
  *      Throws std::runtime_error or sub-class if:
  *          - The file cannot be opened.
  *          - The file ends unexpectedly.
+ *          - The header holds a negative size or one too large to allocate.
  */
 Grid Zoo::load_binary(const std::string& path){
     // open file
@@ -302,53 +307,63 @@ Grid Zoo::load_binary(const std::string& path){
         throw std::runtime_error("Zoo::load_binary(): Could not open file, path does not exist:" + path);
     }
 
-    // work out size of file
-    const int start = read.tellg();
-    read.seekg(0,std::ios::end);
-    const int end = read.tellg();
-    const int size = end - start;
-    read.seekg(0,std::ios::beg);
-
-    // if the size of the file is less than the required 8 bytes file is too short.
-    if(size < 8){
+    // Read the width and heights
+    std::int32_t width;
+    std::int32_t height;
+    if(!read.read((char *) &width, 4) || !read.read((char *) &height, 4)){
         read.close();
         throw std::runtime_error("Zoo::load_binary(): Unexpected end of file");
     }
+    if(width < 0 || height < 0){
+        read.close();
+        throw std::runtime_error("Zoo::load_binary(): Negative sizes are not valid dimensions");
+    }
 
-    // width and height and written grid
-    int width;
-    int height;
-
-    // Read the width and heights
-    read.read((char *) &width, 4);
-    read.read((char *) &height, 4);
+    // The bit count can pass 2^31 so the byte count is worked out in 64 bits
+    const std::uint64_t total_bits = static_cast<std::uint64_t>(width) * static_cast<std::uint64_t>(height);
+    std::uint64_t bytes_left = (total_bits + 7) / 8;
 
-    // bytes remaining
-    const int remainder = std::ceil((width * height)/8);
-    // Check enough bytes exist in the file
-    if (size - 8 < remainder){
+    // Check the file holds every cell before allocating, so a short file cannot claim a huge grid
+    const std::streampos cells_start = read.tellg();
+    read.seekg(0, std::ios::end);
+    const std::streamoff file_bytes_left = read.tellg() - cells_start;
+    read.seekg(cells_start);
+    if(!read || file_bytes_left < 0 || static_cast<std::uint64_t>(file_bytes_left) < bytes_left){
         read.close();
         throw std::runtime_error("Zoo::load_binary(): Unexpected end of file");
     }
-    int bit_grid;
-    // Read bytes into the bit grid
-    read.read((char *)&bit_grid, (size - 8));
-    // Close the file
-    read.close();
-    // Make the grid
+
+    // Make the grid, this checks the size fits in memory before anything is read
     Grid grid(width, height);
 
-    // loop through checking each bit adding a alive if cell is alive
-    for (int y = 0; y < height; y++){
-        int offset = width * y;
-        for (int x=0; x<width; x++) {
-            int curbit = (bit_grid >> (x + offset)) & 1;
-            if (curbit == 1) {
-                grid.set(x, y, Cell::ALIVE);
+    // Read the bits a chunk at a time, walking the cells in row order
+    std::vector<char> buffer(1 << 16);
+    int x = 0;
+    int y = 0;
+    while(bytes_left > 0){
+        const std::size_t chunk = std::min<std::uint64_t>(buffer.size(), bytes_left);
+        if(!read.read(buffer.data(), chunk)){
+            read.close();
+            throw std::runtime_error("Zoo::load_binary(): Unexpected end of file");
+        }
+        for(std::size_t i = 0; i < chunk; i++){
+            const auto byte = static_cast<unsigned char>(buffer[i]);
+            for(int bit = 0; bit < 8 && y < height; bit++){
+                if((byte >> bit) & 1){
+                    grid(x, y) = Cell::ALIVE;
+                }
+                if(++x == width){
+                    x = 0;
+                    y++;
+                }
             }
         }
+        bytes_left -= chunk;
     }
 
+    // Close the file
+    read.close();
+
     return grid;
 }
 
@@ -376,25 +391,15 @@ Grid Zoo::load_binary(const std::string& path){
  *      The std::string path to the file to write to.
  *
  * @param grid
- *      The grid to be written out to file.
+ *      The grid to be written out to file, or a view of part of a grid.
  *
  * @throws
  *      Throws std::runtime_error or sub-class if the file cannot be opened.
 */
-void Zoo::save_binary(const std::string& path, const Grid& grid) {
+void Zoo::save_binary(const std::string& path, const GridView& grid) {
     // Get width and height
-    const int width = grid.get_width();
-    const int height = grid.get_height();
-
-    // The total required bits
-    int required = width * height;
-
-    // Find number of bytes (add padding first if needed)
-    if (required%8 != 0){
-        required += (8-(required%8));
-    }
-
-    required = required/8;
+    const std::int32_t width = grid.get_width();
+    const std::int32_t height = grid.get_height();
 
     // of stream
     std::ofstream write(path, std::ios::binary | std::ios::out);
@@ -406,42 +411,37 @@ void Zoo::save_binary(const std::string& path, const Grid& grid) {
     }
 
     // Write the 4byte size
-    write.write((char*)&width, 4);
-    write.write((char*)&height, 4);
-
-    // set the bit grid
-    int bit_grid = 0;
-    // To count written bits
-    int counter = 0;
-    // To count written bytes
-    int tracker = 0;
-
+    write.write((const char*)&width, 4);
+    write.write((const char*)&height, 4);
+
+    // Pack the cells lowest bit first, flushing the buffer whenever it fills up
+    std::vector<char> buffer;
+    buffer.reserve(1 << 16);
+    unsigned char byte = 0;
+    int bit = 0;
     for (int y = 0; y < height; y++){
-        int offset = width * y;
-        for (int x=0; x<width; x++) {
-            if (grid.get(x,y) == Cell::ALIVE){
-                // Flip the bit in the integer to a 1 if cell is alive
-                bit_grid |= 1 << (x+offset);
+        for (int x = 0; x < width; x++) {
+            if (grid(x, y) == Cell::ALIVE){
+                byte |= 1u << bit;
             }
-            ++counter; // increase counter by 1
-            // If we reach the size of the integer
-            if (counter > 32){
-                // write the integer as bits
-                write.write((char*)&bit_grid, sizeof(int));
-                // reset vars
-                counter = 0;
-                bit_grid = 0;
-                // increase tracker by 4(bytes)
-                tracker +=4;
+            if (++bit == 8){
+                buffer.push_back(static_cast<char>(byte));
+                byte = 0;
+                bit = 0;
+                if (buffer.size() == buffer.capacity()){
+                    write.write(buffer.data(), buffer.size());
+                    buffer.clear();
+                }
             }
         }
     }
 
-    // Write remaining bytes
-    if(tracker != required/8) {
-        write.write((char *) &bit_grid, required - tracker);
+    // Pad the last byte with 0 bits
+    if (bit != 0){
+        buffer.push_back(static_cast<char>(byte));
     }
+    write.write(buffer.data(), buffer.size());
+
     // Close the stream.
     write.close();
-
 }
@@ -17,6 +17,7 @@
  * Declare the interface of the Zoo namespace for constructing lifeforms and saving and loading them from file.
  */
 #include "grid.h"
+#include "fixed_grid.h"
 
 namespace Zoo {
     // How to draw an owl:
@@ -26,7 +27,52 @@ namespace Zoo {
     Grid r_pentomino();
     Grid light_weight_spaceship();
     Grid load_ascii(const std::string& path);
-    void save_ascii(const std::string& path, const Grid& grid);
+    void save_ascii(const std::string& path, const GridView& grid);
     Grid load_binary(const std::string& path);
-    void save_binary(const std::string& path,const Grid& grid);
-}
\ No newline at end of file
+    void save_binary(const std::string& path, const GridView& grid);
+}
+
+/**
+ * Compile time versions of the Zoo creatures, each drawn on a FixedGrid the size of its bounding box.
+ * These are constexpr so they have to be defined in the header, the drawings match the Grid versions in zoo.cpp.
+ *
+ * @example
+ *
+ *      // A glider that never touches the heap
+ *      constexpr FixedGrid<3, 3> glider = Zoo::Fixed::glider();
+ */
+namespace Zoo::Fixed {
+    constexpr FixedGrid<3, 3> glider(){
+        FixedGrid<3, 3> glider;
+        glider.set(1, 0, Cell::ALIVE);
+        glider.set(2, 1, Cell::ALIVE);
+        glider.set(0, 2, Cell::ALIVE);
+        glider.set(1, 2, Cell::ALIVE);
+        glider.set(2, 2, Cell::ALIVE);
+        return glider;
+    }
+
+    constexpr FixedGrid<3, 3> r_pentomino(){
+        FixedGrid<3, 3> r_pentomino;
+        r_pentomino.set(1, 0, Cell::ALIVE);
+        r_pentomino.set(2, 0, Cell::ALIVE);
+        r_pentomino.set(0, 1, Cell::ALIVE);
+        r_pentomino.set(1, 1, Cell::ALIVE);
+        r_pentomino.set(1, 2, Cell::ALIVE);
+        return r_pentomino;
+    }
+
+    constexpr FixedGrid<5, 4> light_weight_spaceship(){
+        FixedGrid<5, 4> light_weight_spaceship;
+        light_weight_spaceship.set(1, 0, Cell::ALIVE);
+        light_weight_spaceship.set(4, 0, Cell::ALIVE);
+        light_weight_spaceship.set(0, 1, Cell::ALIVE);
+        light_weight_spaceship.set(0, 2, Cell::ALIVE);
+        light_weight_spaceship.set(4, 2, Cell::ALIVE);
+        light_weight_spaceship.set(0, 3, Cell::ALIVE);
+        light_weight_spaceship.set(1, 3, Cell::ALIVE);
+        light_weight_spaceship.set(2, 3, Cell::ALIVE);
+        light_weight_spaceship.set(3, 3, Cell::ALIVE);
+        return light_weight_spaceship;
+    }
+}